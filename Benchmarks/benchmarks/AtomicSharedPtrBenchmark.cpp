@@ -0,0 +1,76 @@
+#include "Benchmark.hpp"
+#include "MTL/AtomicSharedPtr.hpp"
+#include <mutex>
+
+namespace
+{
+	struct config
+	{
+		int version{ 0 };
+		int payload[15]{};
+	};
+
+	class mutex_slot
+	{
+	public:
+		explicit mutex_slot(mtl::shared_ptr<config> value)
+			: m_Value(std::move(value))
+		{
+		}
+		mtl::shared_ptr<config> load() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Value;
+		}
+		void store(mtl::shared_ptr<config> value)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Value = std::move(value);
+		}
+
+	private:
+		mutable std::mutex m_Mutex;
+		mtl::shared_ptr<config> m_Value;
+	};
+
+	// Thread 0 republishes the snapshot in a loop while the others read it.
+	template <typename Slot>
+	void readers_and_writer(const char* label, size_t readers)
+	{
+		constexpr size_t LOADS = 1'000'000;
+		Slot slot(mtl::make_shared<config>());
+		std::atomic<size_t> remaining{ readers };
+
+		double ns = bench::run_parallel(readers + 1, [&](size_t index)
+		{
+			if (index == 0)
+			{
+				for (int version = 1; remaining.load(std::memory_order_relaxed) != 0; ++version)
+				{
+					auto next = mtl::make_shared<config>();
+					next->version = version;
+					slot.store(std::move(next));
+				}
+				return;
+			}
+			long long sum = 0;
+			for (size_t i = 0; i < LOADS; ++i)
+				sum += slot.load()->version;
+			bench::do_not_optimize(sum);
+			remaining.fetch_sub(1, std::memory_order_relaxed);
+		});
+		bench::report(label, ns / LOADS, "ns/load");
+	}
+}
+
+BENCHMARK(SnapshotPublishing)
+{
+	for (size_t readers : { 1, 4, 8 })
+	{
+		char label[64];
+		std::snprintf(label, sizeof(label), "mutex + shared_ptr, %zu readers / 1 writer", readers);
+		readers_and_writer<mutex_slot>(label, readers);
+		std::snprintf(label, sizeof(label), "atomic_shared_ptr, %zu readers / 1 writer", readers);
+		readers_and_writer<mtl::atomic_shared_ptr<config>>(label, readers);
+	}
+}
@@ -0,0 +1,68 @@
+#include "Benchmark.hpp"
+#include "MTL/BiasedRefCount.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr size_t OWNER_COPIES = 5'000'000;
+	constexpr size_t WORKER_COPIES = 500'000;
+
+	// The creating thread copies its handle in a tight loop while `workers`
+	// other threads copy the same handle concurrently; reports the owner's
+	// cost per copy and the workers' cost per copy.
+	template <typename Policy>
+	void fan_out(const char* label, size_t workers)
+	{
+		auto request = mtl::make_shared<int, Policy>(42);
+		std::atomic<bool> go{ false };
+		std::atomic<long long> worker_ns{ 0 };
+
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < workers; ++i)
+		{
+			threads.emplace_back([&]
+			{
+				while (!go.load(std::memory_order_acquire))
+					std::this_thread::yield();
+
+				auto start = bench::clock::now();
+				for (size_t n = 0; n < WORKER_COPIES; ++n)
+				{
+					mtl::shared_ptr<int, Policy> copy(request);
+					bench::do_not_optimize(copy);
+				}
+				worker_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(bench::clock::now() - start).count();
+			});
+		}
+
+		go.store(true, std::memory_order_release);
+		auto start = bench::clock::now();
+		for (size_t n = 0; n < OWNER_COPIES; ++n)
+		{
+			mtl::shared_ptr<int, Policy> copy(request);
+			bench::do_not_optimize(copy);
+		}
+		double owner_ns = std::chrono::duration<double, std::nano>(bench::clock::now() - start).count();
+		for (auto& thread : threads)
+			thread.join();
+
+		char line[96];
+		std::snprintf(line, sizeof(line), "%s, %zu workers: owner", label, workers);
+		bench::report(line, owner_ns / OWNER_COPIES, "ns/copy");
+		if (workers > 0)
+		{
+			std::snprintf(line, sizeof(line), "%s, %zu workers: worker", label, workers);
+			bench::report(line, double(worker_ns.load()) / (workers * WORKER_COPIES), "ns/copy");
+		}
+	}
+}
+
+BENCHMARK(BiasedRefCountFanOut)
+{
+	for (size_t workers : { 0, 1, 3, 7 })
+	{
+		fan_out<mtl::atomic_ref_count>("atomic_ref_count", workers);
+		fan_out<mtl::biased_ref_count>("biased_ref_count", workers);
+	}
+}
@@ -0,0 +1,125 @@
+#include "Benchmark.hpp"
+#include "MTL/CacheLine.hpp"
+#include "MTL/Vector.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+	constexpr size_t INCREMENTS = 10'000'000;
+	constexpr size_t ITEMS = 1'000'000;
+
+	// mtl::vector relocates its elements, which std::atomic does not allow.
+	struct counter
+	{
+		std::atomic<uint64_t> value{ 0 };
+
+		counter() = default;
+		counter(const counter& rhs)
+			: value(rhs.value.load())
+		{
+		}
+	};
+
+	// Every thread bumps only its own counter. Packed counters share cache
+	// lines, so each increment steals the line from the other cores.
+	template <typename Counters>
+	double per_thread_counters(size_t threads)
+	{
+		Counters counters;
+		for (size_t i = 0; i < threads; ++i)
+			counters.emplace_back();
+
+		double ns = bench::run_parallel(threads, [&counters](size_t index)
+		{
+			std::atomic<uint64_t>& value = counters[index].value;
+			for (size_t i = 0; i < INCREMENTS; ++i)
+				value.fetch_add(1, std::memory_order_relaxed);
+		});
+		return ns / INCREMENTS;
+	}
+
+	struct padded_counters
+	{
+		mtl::vector<mtl::cache_padded<counter>, mtl::aligned_allocator<mtl::cache_padded<counter>>> counters;
+
+		void emplace_back()
+		{
+			counters.emplace_back();
+		}
+		counter& operator[](size_t index)
+		{
+			return *counters[index];
+		}
+	};
+
+	// A single-producer ring whose head and tail are written by different
+	// threads, with the indices either adjacent or on their own lines.
+	template <typename Index>
+	double ping_pong_ring()
+	{
+		constexpr size_t CAPACITY = 1024;
+		struct
+		{
+			Index head{};
+			Index tail{};
+			uint64_t slots[CAPACITY]{};
+		} ring;
+
+		double ns = bench::run_parallel(2, [&ring](size_t index)
+		{
+			std::atomic<uint64_t>& head = *ring.head;
+			std::atomic<uint64_t>& tail = *ring.tail;
+			if (index == 0)
+			{
+				for (uint64_t i = 0; i < ITEMS; ++i)
+				{
+					while (i - head.load(std::memory_order_acquire) == CAPACITY)
+						std::this_thread::yield();
+					ring.slots[i % CAPACITY] = i;
+					tail.store(i + 1, std::memory_order_release);
+				}
+			}
+			else
+			{
+				uint64_t sum = 0;
+				for (uint64_t i = 0; i < ITEMS; ++i)
+				{
+					while (tail.load(std::memory_order_acquire) == i)
+						std::this_thread::yield();
+					sum += ring.slots[i % CAPACITY];
+					head.store(i + 1, std::memory_order_release);
+				}
+				bench::do_not_optimize(sum);
+			}
+		});
+		return ns / ITEMS;
+	}
+
+	struct plain_index
+	{
+		std::atomic<uint64_t> value{ 0 };
+
+		std::atomic<uint64_t>& operator*()
+		{
+			return value;
+		}
+	};
+}
+
+BENCHMARK(CacheLine)
+{
+	char label[96];
+	for (size_t threads : { 2, 4 })
+	{
+		std::snprintf(label, sizeof(label), "per-thread counters, packed, %zu threads", threads);
+		bench::report(label, per_thread_counters<mtl::vector<counter>>(threads), "ns/op");
+		std::snprintf(label, sizeof(label), "per-thread counters, cache_padded, %zu threads", threads);
+		bench::report(label, per_thread_counters<padded_counters>(threads), "ns/op");
+	}
+
+	bench::report("ring head/tail, adjacent", ping_pong_ring<plain_index>(), "ns/item");
+	bench::report("ring head/tail, cache_padded", ping_pong_ring<mtl::cache_padded<std::atomic<uint64_t>>>(), "ns/item");
+}
@@ -0,0 +1,119 @@
+#include "Benchmark.hpp"
+#include "MTL/CopyOnWrite.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <string_view>
+
+namespace
+{
+	constexpr size_t ITERATIONS = 1'000;
+	constexpr int STAGES = 8;
+	// Only every WRITE_EVERY-th stage modifies the payload it is handed.
+	constexpr int WRITE_EVERY = 4;
+
+	template <typename T>
+	const T& read(const T& value)
+	{
+		return value;
+	}
+	template <typename T>
+	const T& read(const mtl::cow<T>& value)
+	{
+		return *value;
+	}
+	template <typename T>
+	T& write(T& value)
+	{
+		return value;
+	}
+	template <typename T>
+	T& write(mtl::cow<T>& value)
+	{
+		return value.write();
+	}
+
+	// Each stage takes the payload by value, like an API that keeps what it
+	// is given, and hands it on. Eager payloads copy at every stage; cow
+	// payloads only at the stages that write.
+	template <typename Payload>
+	Payload vector_stage(Payload payload, int stage)
+	{
+		bench::do_not_optimize(read(payload)[stage]);
+		if (stage % WRITE_EVERY == 0)
+			write(payload)[stage] += 1;
+		return payload;
+	}
+
+	template <typename Payload>
+	Payload string_stage(Payload payload, int stage)
+	{
+		bench::do_not_optimize(read(payload).size());
+		if (stage % WRITE_EVERY == 0)
+			write(payload) += "!";
+		return payload;
+	}
+
+	template <typename Payload>
+	void run_pipeline(Payload& payload, Payload (*stage)(Payload, int))
+	{
+		for (int i = 0; i < STAGES; ++i)
+			payload = stage(payload, i);
+	}
+
+	mtl::vector<int> make_numbers()
+	{
+		mtl::vector<int> numbers(100'000);
+		for (size_t i = 0; i < numbers.size(); ++i)
+			numbers[i] = static_cast<int>(i);
+		return numbers;
+	}
+
+	mtl::string make_text()
+	{
+		constexpr char LINE[] = "a line of a document that is passed from stage to stage\n";
+		mtl::vector<char> buffer;
+		for (int i = 0; i < 4096; ++i)
+		{
+			for (char c : std::string_view(LINE))
+				buffer.push_back(c);
+		}
+		buffer.push_back('\0');
+		return mtl::string(buffer.data());
+	}
+}
+
+BENCHMARK(CopyOnWrite)
+{
+	{
+		mtl::vector<int> eager = make_numbers();
+		bench::measure("100K-int vector through 8 stages, eager copies", ITERATIONS, [&]
+		{
+			run_pipeline(eager, &vector_stage<mtl::vector<int>>);
+		});
+		mtl::cow<mtl::vector<int>> shared{ make_numbers() };
+		bench::measure("100K-int vector through 8 stages, cow", ITERATIONS, [&]
+		{
+			run_pipeline(shared, &vector_stage<mtl::cow<mtl::vector<int>>>);
+		});
+	}
+
+	{
+		mtl::string eager = make_text();
+		bench::measure("230KB string through 8 stages, eager copies", ITERATIONS, [&]
+		{
+			run_pipeline(eager, &string_stage<mtl::string>);
+		});
+		mtl::cow<mtl::string> shared{ make_text() };
+		bench::measure("230KB string through 8 stages, cow", ITERATIONS, [&]
+		{
+			run_pipeline(shared, &string_stage<mtl::cow<mtl::string>>);
+		});
+	}
+
+	mtl::cow<mtl::vector<int>> source{ make_numbers() };
+	bench::measure("copy of a shared 100K-int vector, read only, cow", ITERATIONS * 100, [&]
+	{
+		mtl::cow<mtl::vector<int>> copy = source;
+		bench::do_not_optimize(read(copy)[0]);
+	});
+}
@@ -0,0 +1,55 @@
+#include "Benchmark.hpp"
+#include "MTL/DeferredDestruction.hpp"
+#include "MTL/Vector.hpp"
+
+namespace
+{
+	// Stands in for a parsed document: thousands of separately allocated nodes.
+	struct document
+	{
+		explicit document(size_t nodes)
+		{
+			for (size_t i = 0; i < nodes; ++i)
+				this->nodes.push_back(mtl::make_unique<int>(static_cast<int>(i)));
+		}
+
+		mtl::vector<mtl::unique_ptr<int>> nodes;
+	};
+
+	constexpr size_t NODES = 10'000;
+	constexpr size_t DOCUMENTS = 200;
+
+	// Time spent in the final reset() only, which is what the releasing
+	// (latency-critical) thread pays.
+	template <typename Make>
+	double release_cost(Make&& make)
+	{
+		double total = 0;
+		for (size_t i = 0; i < DOCUMENTS; ++i)
+		{
+			auto doc = make();
+			auto start = bench::clock::now();
+			doc.reset();
+			total += std::chrono::duration<double, std::nano>(bench::clock::now() - start).count();
+		}
+		return total / DOCUMENTS;
+	}
+}
+
+BENCHMARK(LastReleaseLatency)
+{
+	bench::report("make_shared, destroyed inline", release_cost([] { return mtl::make_shared<document>(NODES); }), "ns/release");
+
+	mtl::reclamation_queue queue;
+	double deferred = release_cost([&] { return mtl::make_shared_deferred<document>(queue, NODES); });
+	bench::report("make_shared_deferred, queued", deferred, "ns/release");
+
+	auto start = bench::clock::now();
+	queue.drain();
+	double drain = std::chrono::duration<double, std::nano>(bench::clock::now() - start).count();
+	bench::report("drain() per queued document", drain / DOCUMENTS, "ns/document");
+
+	mtl::reclamation_stats stats = queue.stats();
+	bench::report("max queue depth", static_cast<double>(stats.max_depth), "jobs");
+	bench::report("mean release-to-destroyed latency", static_cast<double>(stats.total_latency.count()) / stats.reclaimed, "ns");
+}
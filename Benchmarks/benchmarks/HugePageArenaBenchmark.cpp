@@ -0,0 +1,47 @@
+#include "Benchmark.hpp"
+#include "MTL/HugePageArena.hpp"
+#include "MTL/Vector.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+	constexpr size_t ELEMENTS = 32 * 1024 * 1024;
+	constexpr size_t LOOKUPS = 10'000'000;
+
+	// Random reads across 256 MiB: with 4 KiB pages nearly every lookup misses
+	// the TLB, with 2 MiB pages the page walks mostly stay cached.
+	template <typename Alloc>
+	void random_reads(const char* label, Alloc alloc)
+	{
+		mtl::vector<uint64_t, Alloc> values{ alloc };
+		values.reserve(ELEMENTS);
+		for (size_t i = 0; i < ELEMENTS; ++i)
+			values.push_back(i);
+
+		uint64_t state = 88172645463325252ull;
+		uint64_t sum = 0;
+		bench::measure(label, LOOKUPS, [&]
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			sum += values[state % ELEMENTS];
+		});
+		bench::do_not_optimize(sum);
+		if constexpr (requires { alloc.arena(); })
+			bench::report("  huge pages obtained for 256 MiB", static_cast<double>(alloc.arena().huge_pages_obtained()), "pages");
+	}
+}
+
+BENCHMARK(HugePageArena)
+{
+	random_reads("random reads, std::allocator", std::allocator<uint64_t>{});
+
+	mtl::huge_page_arena plain{ { .allow_explicit = false, .allow_transparent = false } };
+	random_reads("random reads, huge_page_arena without huge pages", mtl::huge_page_allocator<uint64_t>{ plain });
+
+	mtl::huge_page_arena arena;
+	random_reads("random reads, huge_page_arena", mtl::huge_page_allocator<uint64_t>{ arena });
+}
@@ -0,0 +1,116 @@
+#include "Benchmark.hpp"
+#include "MTL/Memory.hpp"
+#include "MTL/MoveOnlyFunction.hpp"
+#include "MTL/Vector.hpp"
+#include <functional>
+#include <memory>
+
+namespace
+{
+	constexpr size_t ITERATIONS = 1'000'000;
+	constexpr size_t TASKS = 1024;
+
+	struct four_words
+	{
+		size_t a, b, c, d;
+	};
+
+	// Owns its payload like the lambda below, but declares itself trivially
+	// relocatable so the queue moves it with a memcpy.
+	struct owned_task
+	{
+		mtl::unique_ptr<size_t> value;
+
+		size_t operator()()
+		{
+			return *value;
+		}
+	};
+
+	// Fills a queue with tasks, then drains it, the way an executor would.
+	template <typename Task, typename MakeTask>
+	size_t run_queue(MakeTask make_task)
+	{
+		mtl::vector<Task> queue;
+		for (size_t i = 0; i < TASKS; ++i)
+			queue.push_back(make_task(i));
+
+		size_t sum = 0;
+		for (size_t i = 0; i < queue.size(); ++i)
+			sum += queue[i]();
+		return sum;
+	}
+}
+
+template <>
+struct mtl::is_trivially_relocatable<owned_task> : mtl::is_trivially_relocatable<mtl::unique_ptr<size_t>>
+{
+};
+
+BENCHMARK(MoveOnlyFunction)
+{
+	size_t seed = 0;
+	bench::measure("construct + call, 2-word capture, std::function", ITERATIONS, [&]
+	{
+		size_t* counter = &seed;
+		std::function<size_t()> func = [counter, step = seed] { return *counter + step; };
+		bench::do_not_optimize(func());
+		++seed;
+	});
+	bench::measure("construct + call, 2-word capture, move_only_function", ITERATIONS, [&]
+	{
+		size_t* counter = &seed;
+		mtl::move_only_function<size_t()> func = [counter, step = seed] { return *counter + step; };
+		bench::do_not_optimize(func());
+		++seed;
+	});
+
+	bench::measure("construct + call, 4-word capture, std::function", ITERATIONS, [&]
+	{
+		four_words words{ seed, seed + 1, seed + 2, seed + 3 };
+		std::function<size_t()> func = [words] { return words.a + words.d; };
+		bench::do_not_optimize(func());
+		++seed;
+	});
+	bench::measure("construct + call, 4-word capture, move_only_function", ITERATIONS, [&]
+	{
+		four_words words{ seed, seed + 1, seed + 2, seed + 3 };
+		mtl::move_only_function<size_t()> func = [words] { return words.a + words.d; };
+		bench::do_not_optimize(func());
+		++seed;
+	});
+
+	std::function<size_t(size_t)> stored_std = [&seed](size_t value) { return value ^ seed; };
+	mtl::move_only_function<size_t(size_t)> stored_mtl = [&seed](size_t value) { return value ^ seed; };
+	bench::measure("call only, std::function", ITERATIONS * 10, [&]
+	{
+		bench::do_not_optimize(stored_std(++seed));
+	});
+	bench::measure("call only, move_only_function", ITERATIONS * 10, [&]
+	{
+		bench::do_not_optimize(stored_mtl(++seed));
+	});
+
+	// std::function needs a copyable capture, so it has to share ownership.
+	bench::measure("1024-task queue, std::function + shared_ptr", 1'000, [&]
+	{
+		bench::do_not_optimize(run_queue<std::function<size_t()>>([](size_t i)
+		{
+			return [value = std::make_shared<size_t>(i)] { return *value; };
+		}));
+	});
+	bench::measure("1024-task queue, move_only_function + unique_ptr", 1'000, [&]
+	{
+		bench::do_not_optimize(run_queue<mtl::move_only_function<size_t()>>([](size_t i)
+		{
+			return [value = mtl::unique_ptr<size_t>(new size_t(i))] { return *value; };
+		}));
+	});
+	bench::measure("1024-task queue, move_only_function + relocatable functor", 1'000, [&]
+	{
+		bench::do_not_optimize(run_queue<mtl::move_only_function<size_t()>>([](size_t i)
+		{
+			return owned_task{ mtl::unique_ptr<size_t>(new size_t(i)) };
+		}));
+	});
+}
@@ -0,0 +1,65 @@
+#include "Benchmark.hpp"
+#include "MTL/ObjectPool.hpp"
+
+namespace
+{
+	// An expensive-to-build object: a parser context with a scratch buffer.
+	struct parser_context
+	{
+		parser_context()
+			: scratch(mtl::make_unique_for_overwrite<char[]>(SCRATCH))
+		{
+		}
+		void reset()
+		{
+			depth = 0;
+		}
+
+		static constexpr size_t SCRATCH = 4096;
+		mtl::unique_ptr<char[]> scratch;
+		int depth{ 0 };
+	};
+
+	constexpr size_t OPS = 1'000'000;
+	constexpr size_t IN_FLIGHT = 16;
+}
+
+BENCHMARK(ObjectPoolChurn)
+{
+	bench::measure("make_unique / delete", OPS, []
+	{
+		auto context = mtl::make_unique<parser_context>();
+		context->scratch[0] = 1;
+		bench::do_not_optimize(context.get());
+	});
+
+	mtl::object_pool<parser_context> pool;
+	bench::measure("object_pool acquire / return", OPS, [&]
+	{
+		auto context = pool.acquire();
+		context->scratch[0] = 1;
+		bench::do_not_optimize(context.get());
+	});
+
+	for (size_t threads : { 1, 4 })
+	{
+		char label[64];
+		double ns = bench::run_parallel(threads, [](size_t)
+		{
+			mtl::unique_ptr<parser_context> held[IN_FLIGHT];
+			for (size_t i = 0; i < OPS; ++i)
+				held[i % IN_FLIGHT] = mtl::make_unique<parser_context>();
+		});
+		std::snprintf(label, sizeof(label), "make_unique, %zu threads, %zu in flight", threads, IN_FLIGHT);
+		bench::report(label, ns / OPS, "ns/op");
+
+		ns = bench::run_parallel(threads, [&](size_t)
+		{
+			mtl::object_pool<parser_context>::handle held[IN_FLIGHT];
+			for (size_t i = 0; i < OPS; ++i)
+				held[i % IN_FLIGHT] = pool.acquire();
+		});
+		std::snprintf(label, sizeof(label), "object_pool, %zu threads, %zu in flight", threads, IN_FLIGHT);
+		bench::report(label, ns / OPS, "ns/op");
+	}
+}
@@ -0,0 +1,97 @@
+#include "Benchmark.hpp"
+#include "MTL/AtomicSharedPtr.hpp"
+#include "MTL/EpochDomain.hpp"
+#include "MTL/HazardPointer.hpp"
+
+namespace
+{
+	struct entry : mtl::hazard_pointer_obj_base<entry>
+	{
+		int version{ 0 };
+	};
+
+	constexpr size_t READS = 1'000'000;
+}
+
+// Cost of one protected read of a published object, no writer.
+BENCHMARK(ProtectedRead)
+{
+	{
+		mtl::atomic_shared_ptr<entry> slot(mtl::make_shared<entry>());
+		bench::measure("atomic_shared_ptr load", READS, [&]
+		{
+			bench::do_not_optimize(slot.load()->version);
+		});
+	}
+	{
+		std::atomic<entry*> slot{ new entry() };
+		mtl::hazard_pointer hazard = mtl::make_hazard_pointer();
+		bench::measure("hazard_pointer protect", READS, [&]
+		{
+			bench::do_not_optimize(hazard.protect(slot)->version);
+			hazard.reset_protection();
+		});
+		delete slot.load();
+	}
+	{
+		mtl::rcu_cell<entry> cell(mtl::make_unique<entry>());
+		bench::measure("epoch pin + rcu_cell read", READS, [&]
+		{
+			bench::do_not_optimize(cell.read([](const entry* value) { return value->version; }));
+		});
+		mtl::epoch_guard guard = cell.domain().pin();
+		bench::measure("rcu_cell read under an outer pin", READS, [&]
+		{
+			bench::do_not_optimize(cell.read([](const entry* value) { return value->version; }));
+		});
+	}
+}
+
+// Thread 0 republishes the object while the others read it.
+BENCHMARK(ReadMostlyPublishing)
+{
+	for (size_t readers : { 1, 4 })
+	{
+		char label[64];
+		{
+			mtl::atomic_shared_ptr<entry> slot(mtl::make_shared<entry>());
+			std::atomic<size_t> remaining{ readers };
+			double ns = bench::run_parallel(readers + 1, [&](size_t index)
+			{
+				if (index == 0)
+				{
+					while (remaining.load(std::memory_order_relaxed) != 0)
+						slot.store(mtl::make_shared<entry>());
+					return;
+				}
+				long long sum = 0;
+				for (size_t i = 0; i < READS; ++i)
+					sum += slot.load()->version;
+				bench::do_not_optimize(sum);
+				remaining.fetch_sub(1, std::memory_order_relaxed);
+			});
+			std::snprintf(label, sizeof(label), "atomic_shared_ptr, %zu readers / 1 writer", readers);
+			bench::report(label, ns / READS, "ns/read");
+		}
+		{
+			mtl::rcu_cell<entry> cell(mtl::make_unique<entry>());
+			std::atomic<size_t> remaining{ readers };
+			double ns = bench::run_parallel(readers + 1, [&](size_t index)
+			{
+				if (index == 0)
+				{
+					while (remaining.load(std::memory_order_relaxed) != 0)
+						cell.store(mtl::make_unique<entry>());
+					return;
+				}
+				long long sum = 0;
+				for (size_t i = 0; i < READS; ++i)
+					sum += cell.read([](const entry* value) { return value->version; });
+				bench::do_not_optimize(sum);
+				remaining.fetch_sub(1, std::memory_order_relaxed);
+			});
+			std::snprintf(label, sizeof(label), "rcu_cell, %zu readers / 1 writer", readers);
+			bench::report(label, ns / READS, "ns/read");
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#include "Benchmark.hpp"
+#include "MTL/Memory.hpp"
+#include "MTL/Vector.hpp"
+
+namespace
+{
+	template <typename Policy>
+	struct tree_node
+	{
+		int value{ 0 };
+		mtl::shared_ptr<tree_node, Policy> left;
+		mtl::shared_ptr<tree_node, Policy> right;
+	};
+
+	template <typename Policy>
+	mtl::shared_ptr<tree_node<Policy>, Policy> build_tree(int depth)
+	{
+		auto node = mtl::make_shared<tree_node<Policy>, Policy>();
+		node->value = depth;
+		if (depth > 0)
+		{
+			node->left = build_tree<Policy>(depth - 1);
+			node->right = build_tree<Policy>(depth - 1);
+		}
+		return node;
+	}
+
+	// Depth-first walk that copies every handle onto an explicit stack, the
+	// way a visitor holding onto nodes would.
+	template <typename Policy>
+	long long traverse(const mtl::shared_ptr<tree_node<Policy>, Policy>& root)
+	{
+		mtl::vector<mtl::shared_ptr<tree_node<Policy>, Policy>> stack;
+		stack.push_back(root);
+		long long sum = 0;
+		while (!stack.empty())
+		{
+			auto node = stack[stack.size() - 1];
+			stack.pop_back();
+			sum += node->value;
+			if (node->left)
+				stack.push_back(node->left);
+			if (node->right)
+				stack.push_back(node->right);
+		}
+		return sum;
+	}
+
+	template <typename Policy>
+	void copy_loop(const char* label)
+	{
+		auto ptr = mtl::make_shared<int, Policy>(1);
+		bench::measure(label, 10'000'000, [&]
+		{
+			mtl::shared_ptr<int, Policy> copy(ptr);
+			bench::do_not_optimize(copy);
+		});
+	}
+}
+
+BENCHMARK(SharedPtrCopy)
+{
+	copy_loop<mtl::atomic_ref_count>("shared_ptr copy + destroy");
+	copy_loop<mtl::local_ref_count>("local_shared_ptr copy + destroy");
+}
+
+BENCHMARK(SharedPtrTreeTraversal)
+{
+	constexpr int DEPTH = 16;
+	auto atomic_tree = build_tree<mtl::atomic_ref_count>(DEPTH);
+	auto local_tree = build_tree<mtl::local_ref_count>(DEPTH);
+
+	bench::measure("shared_ptr tree traversal (2^17 nodes)", 50, [&]
+	{
+		bench::do_not_optimize(traverse(atomic_tree));
+	});
+	bench::measure("local_shared_ptr tree traversal (2^17 nodes)", 50, [&]
+	{
+		bench::do_not_optimize(traverse(local_tree));
+	});
+}
+
+BENCHMARK(SharedPtrAdoption)
+{
+	auto before = mtl::control_block_pool_stats();
+	bench::measure("shared_ptr(new int) + release", 5'000'000, []
+	{
+		mtl::shared_ptr<int> ptr(new int(1));
+		bench::do_not_optimize(ptr);
+	});
+	auto after = mtl::control_block_pool_stats();
+	bench::report("control block slab allocations during run", double(after.slab_allocations - before.slab_allocations), "mallocs");
+}
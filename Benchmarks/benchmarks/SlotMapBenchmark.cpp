@@ -0,0 +1,173 @@
+#include "Benchmark.hpp"
+#include "MTL/List.hpp"
+#include "MTL/Memory.hpp"
+#include "MTL/SlotMap.hpp"
+#include "MTL/Vector.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	constexpr size_t ENTITIES = 1'000'000;
+
+	struct entity
+	{
+		float position[3];
+		float velocity[3];
+		uint32_t id;
+	};
+
+	struct slot_map_store
+	{
+		using handle = mtl::slot_handle;
+		mtl::slot_map<entity> entities;
+
+		handle insert(const entity& value)
+		{
+			return entities.insert(value);
+		}
+		entity& get(handle key)
+		{
+			return entities[key];
+		}
+		void erase(handle key)
+		{
+			entities.erase(key);
+		}
+		template <typename Fn>
+		void for_each(Fn&& fn)
+		{
+			for (entity& value : entities)
+				fn(value);
+		}
+	};
+
+	struct list_store
+	{
+		using handle = decltype(std::declval<mtl::list<entity>&>().begin());
+		mtl::list<entity> entities;
+
+		handle insert(const entity& value)
+		{
+			return entities.insert(entities.end(), value);
+		}
+		entity& get(handle key)
+		{
+			return *key;
+		}
+		void erase(handle key)
+		{
+			entities.erase(key);
+		}
+		template <typename Fn>
+		void for_each(Fn&& fn)
+		{
+			for (entity& value : entities)
+				fn(value);
+		}
+	};
+
+	struct hash_map_store
+	{
+		using handle = uint64_t;
+		std::unordered_map<uint64_t, mtl::unique_ptr<entity>> entities;
+		uint64_t next_id{ 0 };
+
+		handle insert(const entity& value)
+		{
+			entities.emplace(next_id, mtl::unique_ptr<entity>(new entity(value)));
+			return next_id++;
+		}
+		entity& get(handle key)
+		{
+			return *entities.find(key)->second;
+		}
+		void erase(handle key)
+		{
+			entities.erase(key);
+		}
+		template <typename Fn>
+		void for_each(Fn&& fn)
+		{
+			for (auto& [key, value] : entities)
+				fn(*value);
+		}
+	};
+
+	template <typename Fn>
+	void phase(const char* store, const char* operation, size_t count, Fn&& fn)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		char label[96];
+		std::snprintf(label, sizeof(label), "%s, %s", operation, store);
+		bench::report(label, ns / count, "ns/entity");
+	}
+
+	float integrate(entity& value)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+			value.position[axis] += value.velocity[axis];
+		return value.position[0];
+	}
+
+	// Inserts every entity, touches them by handle in random order, updates
+	// them all in iteration order, erases a random half and iterates again.
+	template <typename Store>
+	void run(const char* name)
+	{
+		Store store;
+		std::vector<typename Store::handle> handles;
+		handles.reserve(ENTITIES);
+
+		phase(name, "insert", ENTITIES, [&]
+		{
+			for (uint32_t i = 0; i < ENTITIES; ++i)
+				handles.push_back(store.insert({ { 0, 0, 0 }, { 1, 2, 3 }, i }));
+		});
+
+		std::shuffle(handles.begin(), handles.end(), std::mt19937(7));
+		phase(name, "random lookup", ENTITIES, [&]
+		{
+			uint64_t sum = 0;
+			for (const auto& key : handles)
+				sum += store.get(key).id;
+			bench::do_not_optimize(sum);
+		});
+
+		phase(name, "iterate", ENTITIES, [&]
+		{
+			float sum = 0;
+			store.for_each([&sum](entity& value) { sum += integrate(value); });
+			bench::do_not_optimize(sum);
+		});
+
+		phase(name, "random erase", ENTITIES / 2, [&]
+		{
+			for (size_t i = 0; i < ENTITIES / 2; ++i)
+				store.erase(handles[i]);
+		});
+
+		phase(name, "iterate after erase", ENTITIES / 2, [&]
+		{
+			float sum = 0;
+			store.for_each([&sum](entity& value) { sum += integrate(value); });
+			bench::do_not_optimize(sum);
+		});
+	}
+}
+
+BENCHMARK(SlotMap)
+{
+	run<slot_map_store>("slot_map");
+	run<list_store>("mtl::list");
+	run<hash_map_store>("unordered_map of unique_ptr");
+}
@@ -0,0 +1,66 @@
+#include "Benchmark.hpp"
+#include "MTL/StackArena.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <memory>
+
+namespace
+{
+	constexpr size_t ITERATIONS = 1'000'000;
+	constexpr int ELEMENTS = 48;
+
+	template <typename Vector>
+	int fill_and_sum(Vector& values, int seed)
+	{
+		for (int i = 0; i < ELEMENTS; ++i)
+			values.push_back(seed + i);
+		int sum = 0;
+		for (int value : values)
+			sum += value;
+		return sum;
+	}
+}
+
+BENCHMARK(StackArena)
+{
+	int seed = 0;
+	bench::measure("vector temporary, std::allocator", ITERATIONS, [&]
+	{
+		mtl::vector<int> values;
+		bench::do_not_optimize(fill_and_sum(values, ++seed));
+	});
+	bench::measure("vector temporary, short_alloc", ITERATIONS, [&]
+	{
+		mtl::stack_arena<1024> arena;
+		mtl::vector<int, mtl::short_alloc<int, 1024>> values{ arena };
+		bench::do_not_optimize(fill_and_sum(values, ++seed));
+	});
+
+	bench::measure("reserved vector temporary, std::allocator", ITERATIONS, [&]
+	{
+		mtl::vector<int> values;
+		values.reserve(ELEMENTS);
+		bench::do_not_optimize(fill_and_sum(values, ++seed));
+	});
+	bench::measure("reserved vector temporary, short_alloc", ITERATIONS, [&]
+	{
+		mtl::stack_arena<256> arena;
+		mtl::vector<int, mtl::short_alloc<int, 256>> values{ arena };
+		values.reserve(ELEMENTS);
+		bench::do_not_optimize(fill_and_sum(values, ++seed));
+	});
+
+	bench::measure("string temporary, std::allocator", ITERATIONS, [&]
+	{
+		mtl::string text("a key that does not fit the small buffer");
+		text += "/suffix";
+		bench::do_not_optimize(text.size());
+	});
+	bench::measure("string temporary, short_alloc", ITERATIONS, [&]
+	{
+		mtl::stack_arena<128> arena;
+		mtl::basic_string<mtl::short_alloc<char, 128>> text("a key that does not fit the small buffer", arena);
+		text += "/suffix";
+		bench::do_not_optimize(text.size());
+	});
+}
@@ -0,0 +1,60 @@
+#include "Benchmark.hpp"
+#include "MTL/String.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	constexpr size_t LARGE_SIZES[]{ 1 << 20, 16 << 20 };
+
+	double gigabytes_per_second(size_t bytes, double ns)
+	{
+		return bytes / ns;
+	}
+}
+
+BENCHMARK(LargeBufferInitialization)
+{
+	for (size_t size : LARGE_SIZES)
+	{
+		std::vector<char> source(size, 'a');
+		char label[64];
+
+		std::snprintf(label, sizeof(label), "make_unique<char[]> + copy (%zu KiB)", size >> 10);
+		double zeroed = bench::measure(label, 20, [&]
+		{
+			auto buffer = mtl::make_unique<char[]>(size);
+			std::copy_n(source.data(), size, buffer.get());
+			bench::do_not_optimize(buffer[size - 1]);
+		});
+		bench::report("  throughput", gigabytes_per_second(size, zeroed), "GB/s");
+
+		std::snprintf(label, sizeof(label), "make_unique_for_overwrite<char[]> + copy (%zu KiB)", size >> 10);
+		double overwrite = bench::measure(label, 20, [&]
+		{
+			auto buffer = mtl::make_unique_for_overwrite<char[]>(size);
+			std::copy_n(source.data(), size, buffer.get());
+			bench::do_not_optimize(buffer[size - 1]);
+		});
+		bench::report("  throughput", gigabytes_per_second(size, overwrite), "GB/s");
+	}
+}
+
+BENCHMARK(LargeStringCopy)
+{
+	for (size_t size : LARGE_SIZES)
+	{
+		std::vector<char> source(size, 'a');
+		source.back() = '\0';
+		mtl::string original(source.data());
+		char label[64];
+
+		std::snprintf(label, sizeof(label), "mtl::string copy (%zu KiB)", size >> 10);
+		double ns = bench::measure(label, 20, [&]
+		{
+			mtl::string copy(original);
+			bench::do_not_optimize(copy[0]);
+		});
+		bench::report("  throughput", gigabytes_per_second(size, ns), "GB/s");
+	}
+}
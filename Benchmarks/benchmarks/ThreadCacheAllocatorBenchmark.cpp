@@ -0,0 +1,90 @@
+#include "Benchmark.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/ThreadCacheAllocator.hpp"
+#include <memory>
+
+namespace
+{
+	constexpr size_t OPS = 1'000'000;
+	constexpr size_t LIVE = 256;
+
+	// Each thread keeps a window of LIVE blocks of mixed sizes, freeing the
+	// oldest as it allocates the next.
+	template <template <typename> class Alloc>
+	double mixed_sizes(size_t threads)
+	{
+		double ns = bench::run_parallel(threads, [](size_t index)
+		{
+			Alloc<std::byte> alloc;
+			std::byte* blocks[LIVE]{};
+			size_t sizes[LIVE]{};
+			for (size_t i = 0; i < OPS; ++i)
+			{
+				size_t slot = i % LIVE;
+				if (blocks[slot])
+					alloc.deallocate(blocks[slot], sizes[slot]);
+
+				sizes[slot] = 16 + (i * 2654435761u + index) % 1024;
+				blocks[slot] = alloc.allocate(sizes[slot]);
+				blocks[slot][0] = std::byte{ 1 };
+			}
+			for (size_t slot = 0; slot < LIVE; ++slot)
+				alloc.deallocate(blocks[slot], sizes[slot]);
+		});
+		return ns / OPS;
+	}
+
+	template <template <typename> class Alloc>
+	double list_churn(size_t threads)
+	{
+		double ns = bench::run_parallel(threads, [](size_t)
+		{
+			mtl::list<int, Alloc<int>> items;
+			for (size_t i = 0; i < OPS; ++i)
+			{
+				items.push_back(static_cast<int>(i));
+				if (items.size() > LIVE)
+					items.pop_front();
+			}
+		});
+		return ns / OPS;
+	}
+
+	template <template <typename> class Alloc>
+	double string_churn(size_t threads)
+	{
+		double ns = bench::run_parallel(threads, [](size_t)
+		{
+			for (size_t i = 0; i < OPS / 10; ++i)
+			{
+				mtl::basic_string<Alloc<char>> text("a heap-allocated string of moderate length");
+				text += " with a suffix that forces one reallocation";
+				bench::do_not_optimize(text.size());
+			}
+		});
+		return ns / (OPS / 10);
+	}
+}
+
+BENCHMARK(ThreadCacheAllocator)
+{
+	for (size_t threads : { 1, 4 })
+	{
+		char label[64];
+		std::snprintf(label, sizeof(label), "mixed sizes, std::allocator, %zu threads", threads);
+		bench::report(label, mixed_sizes<std::allocator>(threads), "ns/op");
+		std::snprintf(label, sizeof(label), "mixed sizes, thread_cache_allocator, %zu threads", threads);
+		bench::report(label, mixed_sizes<mtl::thread_cache_allocator>(threads), "ns/op");
+
+		std::snprintf(label, sizeof(label), "list churn, std::allocator, %zu threads", threads);
+		bench::report(label, list_churn<std::allocator>(threads), "ns/op");
+		std::snprintf(label, sizeof(label), "list churn, thread_cache_allocator, %zu threads", threads);
+		bench::report(label, list_churn<mtl::thread_cache_allocator>(threads), "ns/op");
+
+		std::snprintf(label, sizeof(label), "string churn, std::allocator, %zu threads", threads);
+		bench::report(label, string_churn<std::allocator>(threads), "ns/string");
+		std::snprintf(label, sizeof(label), "string churn, thread_cache_allocator, %zu threads", threads);
+		bench::report(label, string_churn<mtl::thread_cache_allocator>(threads), "ns/string");
+	}
+}
@@ -0,0 +1,60 @@
+#include "Benchmark.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/TrackingAllocator.hpp"
+#include "MTL/Vector.hpp"
+#include <memory>
+
+namespace
+{
+	constexpr size_t ELEMENTS = 1'000'000;
+
+	struct VectorTag { static constexpr const char* name = "bench.vector"; };
+	struct DequeTag { static constexpr const char* name = "bench.deque"; };
+
+	void report_allocations(const char* label, const mtl::allocation_stats& stats)
+	{
+		char line[96];
+		std::snprintf(line, sizeof(line), "%s allocations", label);
+		bench::report(line, static_cast<double>(stats.allocations), "");
+		std::snprintf(line, sizeof(line), "%s bytes allocated", label);
+		bench::report(line, static_cast<double>(stats.bytes_allocated), "B");
+		std::snprintf(line, sizeof(line), "%s peak bytes", label);
+		bench::report(line, static_cast<double>(stats.peak_bytes), "B");
+	}
+
+	template <typename Container>
+	void fill(const char* label)
+	{
+		bench::measure(label, 10, []
+		{
+			Container values;
+			for (size_t i = 0; i < ELEMENTS; ++i)
+				values.push_back(static_cast<int>(i));
+			bench::do_not_optimize(values.size());
+		});
+	}
+}
+
+BENCHMARK(TrackingAllocator)
+{
+	fill<mtl::vector<int>>("vector fill 1M, std::allocator");
+	fill<mtl::vector<int, mtl::tracking_allocator<int, VectorTag>>>("vector fill 1M, tracking_allocator");
+	fill<mtl::deque<int>>("deque fill 1M, std::allocator");
+	fill<mtl::deque<int, mtl::tracking_allocator<int, DequeTag>>>("deque fill 1M, tracking_allocator");
+
+	// What one fill costs in allocations, not just time.
+	{
+		mtl::allocation_scope scope{ VectorTag::name };
+		mtl::vector<int, mtl::tracking_allocator<int, VectorTag>> values;
+		for (size_t i = 0; i < ELEMENTS; ++i)
+			values.push_back(static_cast<int>(i));
+		report_allocations("vector fill 1M:", scope.stats());
+	}
+	{
+		mtl::allocation_scope scope{ DequeTag::name };
+		mtl::deque<int, mtl::tracking_allocator<int, DequeTag>> values;
+		for (size_t i = 0; i < ELEMENTS; ++i)
+			values.push_back(static_cast<int>(i));
+		report_allocations("deque fill 1M:", scope.stats());
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace bench
+{
+	using clock = std::chrono::steady_clock;
+
+	inline const volatile void* g_Sink{ nullptr };
+
+	template <typename T>
+	void do_not_optimize(const T& value)
+	{
+		g_Sink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	struct entry
+	{
+		const char* name;
+		void (*run)();
+	};
+
+	inline std::vector<entry>& registry()
+	{
+		static std::vector<entry> entries;
+		return entries;
+	}
+
+	struct registrar
+	{
+		registrar(const char* name, void (*run)())
+		{
+			registry().push_back({ name, run });
+		}
+	};
+
+	inline void report(std::string_view label, double value, const char* unit)
+	{
+		std::printf("  %-56.*s %14.2f %s\n", static_cast<int>(label.size()), label.data(), value, unit);
+	}
+
+	// Runs fn() `iterations` times after one warm-up call and reports the mean.
+	template <typename Fn>
+	double measure(std::string_view label, size_t iterations, Fn&& fn)
+	{
+		fn();
+		auto start = clock::now();
+		for (size_t i = 0; i < iterations; ++i)
+			fn();
+		double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / iterations;
+		report(label, ns, "ns/op");
+		return ns;
+	}
+
+	// Starts `threads` workers on fn(thread_index), releases them together and
+	// returns the wall time until the last one finishes.
+	template <typename Fn>
+	double run_parallel(size_t threads, Fn&& fn)
+	{
+		std::atomic<bool> go{ false };
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+		for (size_t i = 0; i < threads; ++i)
+		{
+			workers.emplace_back([&go, &fn, i]
+			{
+				while (!go.load(std::memory_order_acquire))
+					std::this_thread::yield();
+				fn(i);
+			});
+		}
+		auto start = clock::now();
+		go.store(true, std::memory_order_release);
+		for (auto& worker : workers)
+			worker.join();
+		return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+	}
+}
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static ::bench::registrar name##_registrar(#name, &name); \
+	static void name()
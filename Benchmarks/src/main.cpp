@@ -0,0 +1,17 @@
+#include "Benchmark.hpp"
+#include <cstring>
+
+// Usage: Benchmarks [filter]  -- runs every benchmark whose name contains filter.
+int main(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : "";
+	for (const auto& entry : bench::registry())
+	{
+		if (std::strstr(entry.name, filter) == nullptr)
+			continue;
+
+		std::printf("%s\n", entry.name);
+		entry.run();
+	}
+	return 0;
+}
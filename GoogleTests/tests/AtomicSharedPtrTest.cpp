@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include "MTL/AtomicSharedPtr.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Snapshot
+    {
+        inline static std::atomic<int> alive{ 0 };
+
+        Snapshot(int version)
+            : first(version), second(version)
+        {
+            ++alive;
+        }
+        ~Snapshot()
+        {
+            --alive;
+        }
+
+        int first;
+        int second;
+    };
+}
+
+TEST(AtomicSharedPtrTest, LoadStoreExchange) {
+    mtl::atomic_shared_ptr<int> slot;
+    EXPECT_TRUE(slot.is_lock_free());
+    EXPECT_EQ(slot.load().get(), nullptr);
+
+    slot.store(mtl::make_shared<int>(1));
+    mtl::shared_ptr<int> first = slot.load();
+    EXPECT_EQ(*first, 1);
+    EXPECT_EQ(first.use_count(), 2u);
+
+    mtl::shared_ptr<int> previous = slot.exchange(mtl::make_shared<int>(2));
+    EXPECT_EQ(previous.get(), first.get());
+    EXPECT_EQ(*slot.load(), 2);
+
+    slot = mtl::shared_ptr<int>();
+    EXPECT_EQ(first.use_count(), 2u);
+    EXPECT_EQ(slot.load().get(), nullptr);
+}
+
+TEST(AtomicSharedPtrTest, CompareExchange) {
+    auto initial = mtl::make_shared<int>(1);
+    mtl::atomic_shared_ptr<int> slot(initial);
+
+    mtl::shared_ptr<int> expected = mtl::make_shared<int>(1);
+    EXPECT_FALSE(slot.compare_exchange_strong(expected, mtl::make_shared<int>(2)));
+    EXPECT_EQ(expected.get(), initial.get());
+
+    EXPECT_TRUE(slot.compare_exchange_strong(expected, mtl::make_shared<int>(3)));
+    EXPECT_EQ(*slot.load(), 3);
+    EXPECT_EQ(initial.use_count(), 2u);
+}
+
+TEST(AtomicSharedPtrTest, ReadersNeverSeeTornOrFreedSnapshots) {
+    constexpr int READERS = 4;
+    constexpr int VERSIONS = 20000;
+    {
+        mtl::atomic_shared_ptr<Snapshot> slot(mtl::make_shared<Snapshot>(0));
+        std::atomic<bool> done{ false };
+        std::atomic<int> failures{ 0 };
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < READERS; ++i) {
+            readers.emplace_back([&] {
+                int last = 0;
+                while (!done.load(std::memory_order_acquire)) {
+                    mtl::shared_ptr<Snapshot> snapshot = slot.load();
+                    if (snapshot->first != snapshot->second || snapshot->first < last)
+                        ++failures;
+                    last = snapshot->first;
+                }
+            });
+        }
+        for (int version = 1; version <= VERSIONS; ++version)
+            slot.store(mtl::make_shared<Snapshot>(version));
+
+        done.store(true, std::memory_order_release);
+        for (auto& reader : readers)
+            reader.join();
+
+        EXPECT_EQ(failures.load(), 0);
+        EXPECT_EQ(slot.load()->first, VERSIONS);
+        EXPECT_EQ(Snapshot::alive.load(), 1);
+    }
+    EXPECT_EQ(Snapshot::alive.load(), 0);
+}
+
+TEST(AtomicSharedPtrTest, ConcurrentCompareExchangeIncrements) {
+    constexpr int THREADS = 4;
+    constexpr int INCREMENTS = 2000;
+    mtl::atomic_shared_ptr<int> slot(mtl::make_shared<int>(0));
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < THREADS; ++i) {
+        workers.emplace_back([&] {
+            for (int n = 0; n < INCREMENTS; ++n) {
+                mtl::shared_ptr<int> expected = slot.load();
+                while (!slot.compare_exchange_weak(expected, mtl::make_shared<int>(*expected + 1))) {
+                }
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    EXPECT_EQ(*slot.load(), THREADS * INCREMENTS);
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "MTL/BiasedRefCount.hpp"
+#include <thread>
+
+namespace
+{
+    using biased = mtl::biased_ref_count;
+
+    struct Tracked
+    {
+        inline static std::atomic<int> alive{ 0 };
+
+        Tracked()
+        {
+            ++alive;
+        }
+        ~Tracked()
+        {
+            --alive;
+        }
+    };
+}
+
+TEST(BiasedRefCountTest, OwnerThreadCounts) {
+    Tracked::alive = 0;
+    mtl::weak_ptr<Tracked, biased> weak;
+    {
+        auto ptr = mtl::make_shared<Tracked, biased>();
+        auto copy = ptr;
+        weak = copy;
+        EXPECT_EQ(ptr.use_count(), 2u);
+        EXPECT_EQ(weak.lock().get(), ptr.get());
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(BiasedRefCountTest, ReleasedOnOtherThreadThenOwner) {
+    Tracked::alive = 0;
+    auto ptr = mtl::make_shared<Tracked, biased>();
+    mtl::shared_ptr<Tracked, biased> handed_off = ptr;
+
+    std::thread([moved = std::move(handed_off)]() mutable {
+        moved.reset();
+    }).join();
+    EXPECT_EQ(Tracked::alive, 1);
+    EXPECT_EQ(ptr.use_count(), 1u);
+
+    mtl::biased_ref_count::merge_pending();
+    EXPECT_EQ(ptr.use_count(), 1u);
+    ptr.reset();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(BiasedRefCountTest, OwnerReleasesFirst) {
+    Tracked::alive = 0;
+    auto ptr = mtl::make_shared<Tracked, biased>();
+    mtl::shared_ptr<Tracked, biased> copy;
+    std::thread([&] { copy = ptr; }).join();
+
+    ptr.reset();
+    EXPECT_EQ(Tracked::alive, 1);
+    std::thread([&] { copy.reset(); }).join();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(BiasedRefCountTest, OwnerThreadExitsFirst) {
+    Tracked::alive = 0;
+    mtl::shared_ptr<Tracked, biased> survivor;
+    std::thread([&] {
+        auto ptr = mtl::make_shared<Tracked, biased>();
+        survivor = ptr;
+        mtl::shared_ptr<Tracked, biased> extra = ptr;
+        survivor = extra;
+    }).join();
+
+    EXPECT_EQ(Tracked::alive, 1);
+    EXPECT_EQ(survivor.use_count(), 1u);
+    survivor.reset();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(BiasedRefCountTest, ManyThreadsCopyAndRelease) {
+    Tracked::alive = 0;
+    constexpr int THREADS = 4;
+    constexpr int COPIES = 10000;
+    {
+        auto ptr = mtl::make_shared<Tracked, biased>();
+        std::thread workers[THREADS];
+        for (auto& worker : workers) {
+            worker = std::thread([&ptr] {
+                for (int i = 0; i < COPIES; ++i) {
+                    mtl::shared_ptr<Tracked, biased> copy = ptr;
+                    mtl::shared_ptr<Tracked, biased> second = copy;
+                }
+            });
+        }
+        for (int i = 0; i < COPIES; ++i) {
+            mtl::shared_ptr<Tracked, biased> copy = ptr;
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        EXPECT_EQ(ptr.use_count(), 1u);
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+#include "MTL/CacheLine.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/Vector.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t LINE = mtl::hardware_destructive_interference_size;
+
+    bool aligned_to(const void* ptr, size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+    }
+}
+
+TEST(CacheLineTest, InterferenceSizesAreSane) {
+    static_assert((LINE & (LINE - 1)) == 0);
+    static_assert(LINE >= 32);
+    static_assert(mtl::hardware_constructive_interference_size <= LINE);
+}
+
+TEST(CacheLineTest, PaddedValuesOwnTheirLine) {
+    static_assert(alignof(mtl::cache_padded<char>) == LINE);
+    static_assert(sizeof(mtl::cache_padded<char>) == LINE);
+    static_assert(sizeof(mtl::cache_padded<char[LINE + 1]>) == 2 * LINE);
+
+    mtl::cache_padded<int> counters[2]{ 1, 2 };
+    EXPECT_EQ(*counters[0], 1);
+    EXPECT_EQ(*counters[1], 2);
+    EXPECT_GE(reinterpret_cast<uintptr_t>(&counters[1].value) - reinterpret_cast<uintptr_t>(&counters[0].value), LINE);
+
+    mtl::cache_padded<std::atomic<int>> counter{ std::in_place, 5 };
+    counter->fetch_add(1);
+    EXPECT_EQ(counter.value.load(), 6);
+}
+
+TEST(CacheLineTest, VectorOfPaddedCountersKeepsThemApart) {
+    mtl::vector<mtl::cache_padded<uint64_t>, mtl::aligned_allocator<mtl::cache_padded<uint64_t>>> counters;
+    for (int i = 0; i < 8; ++i)
+        counters.emplace_back(0u);
+
+    for (size_t i = 0; i < counters.size(); ++i)
+        EXPECT_TRUE(aligned_to(&counters[i], LINE));
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < counters.size(); ++t)
+    {
+        threads.emplace_back([&counters, t]
+        {
+            for (int i = 0; i < 1000; ++i)
+                std::atomic_ref<uint64_t>(*counters[t]).fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    for (size_t i = 0; i < counters.size(); ++i)
+        EXPECT_EQ(*counters[i], 1000u);
+}
+
+TEST(CacheLineTest, AlignedAllocatorAlignsContainerBuffers) {
+    mtl::vector<int, mtl::aligned_allocator<int>> numbers;
+    for (int i = 0; i < 100; ++i)
+    {
+        numbers.push_back(i);
+        ASSERT_TRUE(aligned_to(numbers.data(), LINE));
+    }
+
+    mtl::vector<char, mtl::aligned_allocator<char, 4096>> page{ 10 };
+    EXPECT_TRUE(aligned_to(page.data(), 4096));
+
+    // The deque rebinds it for its block map.
+    mtl::deque<int, mtl::aligned_allocator<int, 256>> queue;
+    for (int i = 0; i < 100; ++i)
+        queue.push_front(i);
+    EXPECT_EQ(queue[0], 99);
+    EXPECT_EQ(queue[99], 0);
+}
+
+TEST(CacheLineTest, AlignedAllocatorsAreInterchangeable) {
+    mtl::aligned_allocator<int> a;
+    mtl::aligned_allocator<double> b{ a };
+    EXPECT_TRUE(a == b);
+    static_assert(std::allocator_traits<mtl::aligned_allocator<int>>::is_always_equal::value);
+    static_assert(std::is_same_v<std::allocator_traits<mtl::aligned_allocator<int, 256>>::rebind_alloc<long>, mtl::aligned_allocator<long, 256>>);
+    static_assert(mtl::aligned_allocator<std::max_align_t, 1>::alignment == alignof(std::max_align_t));
+}
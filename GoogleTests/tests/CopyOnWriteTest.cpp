@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+#include "MTL/BiasedRefCount.hpp"
+#include "MTL/CopyOnWrite.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    template <typename Policy>
+    concept AcceptedPolicy = requires { typename mtl::cow<int, Policy>; };
+
+    struct CopyCounter
+    {
+        static inline int copies = 0;
+        int value{ 0 };
+
+        CopyCounter() = default;
+        explicit CopyCounter(int value_)
+            : value(value_)
+        {
+        }
+        CopyCounter(const CopyCounter& rhs)
+            : value(rhs.value)
+        {
+            ++copies;
+        }
+        CopyCounter& operator=(const CopyCounter&) = default;
+        bool operator==(const CopyCounter&) const = default;
+    };
+}
+
+TEST(CopyOnWriteTest, CopiesShareStorage) {
+    CopyCounter::copies = 0;
+    mtl::cow<CopyCounter> first{ std::in_place, 7 };
+    mtl::cow<CopyCounter> second = first;
+    mtl::cow<CopyCounter> third = second;
+
+    EXPECT_EQ(CopyCounter::copies, 0);
+    EXPECT_TRUE(first.shares_with(third));
+    EXPECT_EQ(first.use_count(), 3u);
+    EXPECT_EQ(third->value, 7);
+}
+
+TEST(CopyOnWriteTest, WriteClonesOnlyWhenShared) {
+    CopyCounter::copies = 0;
+    mtl::cow<CopyCounter> original{ std::in_place, 1 };
+    original.write().value = 2;
+    EXPECT_EQ(CopyCounter::copies, 0);
+
+    mtl::cow<CopyCounter> copy = original;
+    copy.write().value = 3;
+    EXPECT_EQ(CopyCounter::copies, 1);
+    EXPECT_FALSE(copy.shares_with(original));
+    EXPECT_EQ(original->value, 2);
+    EXPECT_EQ(copy->value, 3);
+
+    // Both are unique again, so further writes stay in place.
+    copy.write().value = 4;
+    original.write().value = 5;
+    EXPECT_EQ(CopyCounter::copies, 1);
+}
+
+TEST(CopyOnWriteTest, AssigningAValueReusesUniqueStorage) {
+    mtl::cow<mtl::vector<int>> numbers{ mtl::vector<int>{ 1, 2, 3 } };
+    const mtl::vector<int>* storage = &*numbers;
+    numbers = mtl::vector<int>{ 4, 5, 6 };
+    EXPECT_EQ((*numbers)[0], 4);
+    EXPECT_EQ(&*numbers, storage);
+
+    mtl::cow<mtl::vector<int>> shared = numbers;
+    numbers = mtl::vector<int>{ 7 };
+    EXPECT_NE(&*numbers, storage);
+    EXPECT_EQ(shared->size(), 3u);
+    EXPECT_EQ(numbers->size(), 1u);
+}
+
+TEST(CopyOnWriteTest, MovedFromIsValueless) {
+    mtl::cow<mtl::string> text{ mtl::string("a header value that lives on the heap") };
+    mtl::cow<mtl::string> moved = std::move(text);
+
+    EXPECT_TRUE(text.valueless_after_move());
+    EXPECT_FALSE(moved.valueless_after_move());
+    EXPECT_STREQ(moved->c_str(), "a header value that lives on the heap");
+
+    text = mtl::string("reassigned");
+    EXPECT_STREQ(text->c_str(), "reassigned");
+}
+
+TEST(CopyOnWriteTest, ComparesByValue) {
+    mtl::cow<int> a{ 1 };
+    mtl::cow<int> b{ 1 };
+    mtl::cow<int> c = a;
+    EXPECT_TRUE(a == b);
+    EXPECT_TRUE(a == c);
+    EXPECT_TRUE(a == 1);
+    c.write() = 2;
+    EXPECT_FALSE(a == c);
+
+    swap(a, c);
+    EXPECT_EQ(*a, 2);
+    EXPECT_EQ(*c, 1);
+}
+
+TEST(CopyOnWriteTest, ThreadsWriteTheirOwnCopies) {
+    constexpr int THREADS = 4;
+    const mtl::cow<mtl::vector<int>> shared{ mtl::vector<int>(1000) };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&shared, t]
+        {
+            for (int round = 0; round < 100; ++round)
+            {
+                mtl::cow<mtl::vector<int>> mine = shared;
+                long sum = 0;
+                for (int value : *mine)
+                    sum += value;
+                EXPECT_EQ(sum, 0);
+
+                mine.write()[0] = t + 1;
+                EXPECT_EQ((*mine)[0], t + 1);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ((*shared)[0], 0);
+    EXPECT_EQ(shared.use_count(), 1u);
+}
+
+TEST(CopyOnWriteTest, LastOwnerWritesInPlaceAfterOthersLetGo) {
+    mtl::cow<mtl::vector<int>> value{ mtl::vector<int>(100) };
+    for (int& item : value.write())
+        item = 1;
+    const int* storage = &(*value)[0];
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([copy = value]() mutable
+        {
+            long sum = 0;
+            for (int item : *copy)
+                sum += item;
+            EXPECT_EQ(sum, 100);
+        });
+    }
+    for (std::thread& reader : readers)
+        reader.join();
+
+    value.write()[0] = 2;
+    EXPECT_EQ(&(*value)[0], storage);
+}
+
+TEST(CopyOnWriteTest, LocalPolicyClonesOnlyWhenShared) {
+    CopyCounter::copies = 0;
+    mtl::cow<CopyCounter, mtl::local_ref_count> original{ std::in_place, 1 };
+    mtl::cow<CopyCounter, mtl::local_ref_count> copy = original;
+    EXPECT_TRUE(copy.shares_with(original));
+    EXPECT_EQ(original.use_count(), 2u);
+
+    copy.write().value = 2;
+    EXPECT_EQ(CopyCounter::copies, 1);
+    EXPECT_EQ(original->value, 1);
+    EXPECT_EQ(copy->value, 2);
+    EXPECT_TRUE(original.unique());
+
+    original.write().value = 3;
+    EXPECT_EQ(CopyCounter::copies, 1);
+
+    // A biased count cannot prove uniqueness, so cow rejects it.
+    static_assert(AcceptedPolicy<mtl::local_ref_count>);
+    static_assert(!AcceptedPolicy<mtl::biased_ref_count>);
+}
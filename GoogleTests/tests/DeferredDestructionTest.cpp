@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "MTL/DeferredDestruction.hpp"
+#include <thread>
+
+namespace
+{
+    struct Document
+    {
+        inline static std::atomic<int> alive{ 0 };
+        inline static std::atomic<std::thread::id> destroyed_on{};
+
+        Document()
+        {
+            ++alive;
+        }
+        ~Document()
+        {
+            --alive;
+            destroyed_on = std::this_thread::get_id();
+        }
+
+        mtl::shared_ptr<Document> child;
+    };
+}
+
+TEST(DeferredDestructionTest, LastReleaseQueuesDestruction) {
+    mtl::reclamation_queue queue;
+    auto doc = mtl::make_shared_deferred<Document>(queue);
+    auto copy = doc;
+
+    doc.reset();
+    EXPECT_EQ(queue.depth(), 0u);
+    copy.reset();
+    EXPECT_EQ(Document::alive, 1);
+    EXPECT_EQ(queue.depth(), 1u);
+
+    EXPECT_EQ(queue.drain(), 1u);
+    EXPECT_EQ(Document::alive, 0);
+    EXPECT_EQ(queue.depth(), 0u);
+
+    mtl::reclamation_stats stats = queue.stats();
+    EXPECT_EQ(stats.enqueued, 1u);
+    EXPECT_EQ(stats.reclaimed, 1u);
+    EXPECT_EQ(stats.max_depth, 1u);
+    EXPECT_GE(stats.max_latency.count(), 0);
+    EXPECT_EQ(stats.total_latency, stats.max_latency);
+}
+
+TEST(DeferredDestructionTest, WeakPtrExpiresBeforeDrain) {
+    mtl::reclamation_queue queue;
+    auto doc = mtl::make_shared_deferred<Document>(queue);
+    mtl::weak_ptr<Document> weak = doc;
+
+    doc.reset();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(weak.lock().get(), nullptr);
+
+    queue.drain();
+    EXPECT_EQ(Document::alive, 0);
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(DeferredDestructionTest, DestructionsQueuedWhileDraining) {
+    mtl::reclamation_queue queue;
+    auto parent = mtl::make_shared_deferred<Document>(queue);
+    parent->child = mtl::make_shared_deferred<Document>(queue);
+    parent->child->child = mtl::make_shared_deferred<Document>(queue);
+
+    parent.reset();
+    EXPECT_EQ(queue.depth(), 1u);
+    EXPECT_EQ(queue.drain(), 3u);
+    EXPECT_EQ(Document::alive, 0);
+}
+
+TEST(DeferredDestructionTest, AllocatorAndPolicy) {
+    mtl::reclamation_queue queue;
+    auto doc = mtl::allocate_shared_deferred<Document, mtl::atomic_ref_count>(queue, std::allocator<int>());
+    EXPECT_EQ(doc.use_count(), 1u);
+
+    doc.reset();
+    EXPECT_EQ(Document::alive, 1);
+    queue.drain();
+    EXPECT_EQ(Document::alive, 0);
+}
+
+TEST(DeferredDestructionTest, BackgroundThreadDrains) {
+    mtl::reclamation_queue queue;
+    queue.start();
+    for (int i = 0; i < 100; ++i)
+        mtl::make_shared_deferred<Document>(queue);
+
+    while (queue.stats().reclaimed != 100)
+        std::this_thread::yield();
+    EXPECT_EQ(Document::alive, 0);
+    EXPECT_NE(Document::destroyed_on.load(), std::this_thread::get_id());
+    queue.stop();
+
+    mtl::make_shared_deferred<Document>(queue);
+    EXPECT_EQ(queue.depth(), 1u);
+}
+
+TEST(DeferredDestructionTest, QueueDestructionDrains) {
+    {
+        mtl::reclamation_queue queue;
+        mtl::make_shared_deferred<Document>(queue);
+        EXPECT_EQ(Document::alive, 1);
+    }
+    EXPECT_EQ(Document::alive, 0);
+}
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include "MTL/EpochDomain.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Tracked
+    {
+        inline static std::atomic<int> alive{ 0 };
+
+        Tracked()
+        {
+            ++alive;
+        }
+        Tracked(const Tracked& rhs)
+            : first(rhs.first), second(rhs.second)
+        {
+            ++alive;
+        }
+        ~Tracked()
+        {
+            --alive;
+        }
+
+        int first{ 0 };
+        int second{ 0 };
+    };
+}
+
+TEST(EpochDomainTest, PinnedReaderDelaysReclamation) {
+    mtl::epoch_domain domain;
+    std::atomic<bool> pinned{ false };
+    std::atomic<bool> release{ false };
+
+    std::thread reader([&] {
+        mtl::epoch_guard guard = domain.pin();
+        pinned = true;
+        while (!release)
+            std::this_thread::yield();
+    });
+    while (!pinned)
+        std::this_thread::yield();
+
+    domain.retire(new Tracked());
+    for (int i = 0; i < 10; ++i)
+        domain.try_advance();
+    EXPECT_LE(domain.epoch(), 1u);
+    EXPECT_EQ(Tracked::alive, 1);
+    EXPECT_EQ(domain.pending_reclamations(), 1u);
+
+    release = true;
+    reader.join();
+    domain.synchronize();
+    EXPECT_EQ(Tracked::alive, 0);
+    EXPECT_EQ(domain.pending_reclamations(), 0u);
+}
+
+TEST(EpochDomainTest, NestedGuardsStayPinned) {
+    mtl::epoch_domain domain;
+    {
+        mtl::epoch_guard outer = domain.pin();
+        {
+            mtl::epoch_guard inner = domain.pin();
+            EXPECT_EQ(&inner.domain(), &domain);
+        }
+        EXPECT_TRUE(domain.try_advance());
+        // Still pinned in epoch 0 by the outer guard.
+        EXPECT_FALSE(domain.try_advance());
+    }
+    EXPECT_TRUE(domain.try_advance());
+    EXPECT_EQ(domain.epoch(), 2u);
+}
+
+TEST(EpochDomainTest, AmortizedCollection) {
+    mtl::epoch_domain domain;
+    for (int i = 0; i < 1000; ++i)
+        domain.retire(new Tracked());
+
+    // Retiring advances the epoch and frees old bags without synchronize().
+    EXPECT_LT(Tracked::alive, 1000);
+    domain.synchronize();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(EpochDomainTest, ExitedThreadBagsAreReclaimed) {
+    mtl::epoch_domain domain;
+    std::thread([&] {
+        for (int i = 0; i < 10; ++i)
+            domain.retire(new Tracked());
+    }).join();
+
+    domain.synchronize();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(EpochDomainTest, DomainDestructionReclaims) {
+    {
+        mtl::epoch_domain domain;
+        domain.retire(new Tracked());
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(EpochDomainTest, RcuCellReadStoreUpdate) {
+    mtl::epoch_domain domain;
+    {
+        mtl::rcu_cell<Tracked> cell(domain);
+        EXPECT_EQ(cell.read([](const Tracked* value) { return value; }), nullptr);
+
+        cell.store(mtl::make_unique<Tracked>());
+        cell.update([](Tracked& value) { value.first = value.second = 7; });
+        {
+            mtl::epoch_guard guard = domain.pin();
+            const Tracked* value = cell.read(guard);
+            EXPECT_EQ(value->first, 7);
+            EXPECT_EQ(value->second, 7);
+        }
+        EXPECT_EQ(cell.read([](const Tracked* value) { return value->first; }), 7);
+        domain.synchronize();
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(EpochDomainTest, RcuCellConcurrentReadersSeeConsistentValues) {
+    mtl::epoch_domain domain;
+    {
+        mtl::rcu_cell<Tracked> cell(mtl::make_unique<Tracked>(), domain);
+        std::atomic<bool> done{ false };
+        std::atomic<int> torn{ 0 };
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r)
+        {
+            readers.emplace_back([&] {
+                while (!done)
+                {
+                    cell.read([&](const Tracked* value) {
+                        if (value->first != value->second)
+                            ++torn;
+                    });
+                }
+            });
+        }
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 2; ++w)
+        {
+            writers.emplace_back([&] {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    cell.update([](Tracked& value) {
+                        ++value.first;
+                        ++value.second;
+                    });
+                }
+            });
+        }
+        for (auto& writer : writers)
+            writer.join();
+        done = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        EXPECT_EQ(torn, 0);
+        EXPECT_EQ(cell.read([](const Tracked* value) { return value->first; }), 2000);
+        domain.synchronize();
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
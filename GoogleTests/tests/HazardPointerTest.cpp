@@ -0,0 +1,231 @@
+#include "gtest/gtest.h"
+#include "MTL/HazardPointer.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Node : mtl::hazard_pointer_obj_base<Node>
+    {
+        inline static std::atomic<int> alive{ 0 };
+
+        explicit Node(int v)
+            : value(v)
+        {
+            ++alive;
+        }
+        ~Node()
+        {
+            --alive;
+        }
+
+        int value;
+        Node* next{ nullptr };
+    };
+
+    struct CountingReclaimer
+    {
+        int* reclaimed;
+
+        template <typename T>
+        void operator()(T* node) const
+        {
+            ++*reclaimed;
+            delete node;
+        }
+    };
+
+    struct TrackedNode : mtl::hazard_pointer_obj_base<TrackedNode, CountingReclaimer>
+    {
+    };
+
+    class Stack
+    {
+    public:
+        explicit Stack(mtl::hazard_pointer_domain& domain)
+            : m_Domain(domain)
+        {
+        }
+        ~Stack()
+        {
+            Node* node = m_Head.load();
+            while (node)
+                delete std::exchange(node, node->next);
+        }
+
+        void push(int value)
+        {
+            Node* node = new Node(value);
+            node->next = m_Head.load(std::memory_order_relaxed);
+            while (!m_Head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+        bool pop(int& value)
+        {
+            mtl::hazard_pointer hazard = mtl::make_hazard_pointer(m_Domain);
+            Node* node = hazard.protect(m_Head);
+            while (node)
+            {
+                if (m_Head.compare_exchange_weak(node, node->next, std::memory_order_acquire, std::memory_order_relaxed))
+                    break;
+                hazard.reset_protection(node);
+                node = hazard.protect(m_Head);
+            }
+            if (!node)
+                return false;
+
+            hazard.reset_protection();
+            value = node->value;
+            node->retire({}, m_Domain);
+            return true;
+        }
+
+    private:
+        mtl::hazard_pointer_domain& m_Domain;
+        std::atomic<Node*> m_Head{ nullptr };
+    };
+}
+
+TEST(HazardPointerTest, ProtectedObjectSurvivesCleanup) {
+    mtl::hazard_pointer_domain domain;
+    std::atomic<Node*> slot{ new Node(1) };
+
+    mtl::hazard_pointer hazard = mtl::make_hazard_pointer(domain);
+    EXPECT_FALSE(hazard.empty());
+    Node* node = hazard.protect(slot);
+    EXPECT_EQ(node->value, 1);
+
+    slot.store(nullptr);
+    node->retire({}, domain);
+    domain.cleanup();
+    EXPECT_EQ(Node::alive, 1);
+    EXPECT_EQ(domain.pending_reclamations(), 1u);
+    EXPECT_EQ(node->value, 1);
+
+    hazard.reset_protection();
+    domain.cleanup();
+    EXPECT_EQ(Node::alive, 0);
+    EXPECT_EQ(domain.pending_reclamations(), 0u);
+}
+
+TEST(HazardPointerTest, TryProtectReportsChangedSource) {
+    mtl::hazard_pointer_domain domain;
+    Node first(1);
+    Node second(2);
+    std::atomic<Node*> slot{ &first };
+
+    mtl::hazard_pointer hazard = mtl::make_hazard_pointer(domain);
+    Node* ptr = &second;
+    EXPECT_FALSE(hazard.try_protect(ptr, slot));
+    EXPECT_EQ(ptr, &first);
+    EXPECT_TRUE(hazard.try_protect(ptr, slot));
+
+    mtl::hazard_pointer moved = std::move(hazard);
+    EXPECT_TRUE(hazard.empty());
+    EXPECT_FALSE(moved.empty());
+}
+
+TEST(HazardPointerTest, RecordsAreReused) {
+    mtl::hazard_pointer_domain domain;
+    std::atomic<Node*> slot{ nullptr };
+    {
+        mtl::hazard_pointer first = mtl::make_hazard_pointer(domain);
+        mtl::hazard_pointer second = mtl::make_hazard_pointer(domain);
+        EXPECT_EQ(first.protect(slot), nullptr);
+        EXPECT_EQ(second.protect(slot), nullptr);
+    }
+    // Released records are cleared, so nothing blocks reclamation.
+    Node* node = new Node(3);
+    mtl::hazard_pointer hazard = mtl::make_hazard_pointer(domain);
+    node->retire({}, domain);
+    domain.cleanup();
+    EXPECT_EQ(Node::alive, 0);
+}
+
+TEST(HazardPointerTest, CustomDeleterAndAmortizedScan) {
+    int reclaimed = 0;
+    {
+        mtl::hazard_pointer_domain domain;
+        for (int i = 0; i < 200; ++i)
+            (new TrackedNode())->retire(CountingReclaimer{ &reclaimed }, domain);
+
+        // Scans run as the retire list fills, without an explicit cleanup.
+        EXPECT_GT(reclaimed, 0);
+        EXPECT_LT(domain.pending_reclamations(), 200u);
+    }
+    EXPECT_EQ(reclaimed, 200);
+}
+
+TEST(HazardPointerTest, ExitedThreadListIsAdopted) {
+    mtl::hazard_pointer_domain domain;
+    std::thread([&] {
+        for (int i = 0; i < 10; ++i)
+            (new Node(i))->retire({}, domain);
+    }).join();
+    EXPECT_EQ(Node::alive, 10);
+
+    domain.cleanup();
+    EXPECT_EQ(Node::alive, 0);
+}
+
+TEST(HazardPointerTest, ThreadOutlivesDomain) {
+    std::atomic<bool> destroyed{ false };
+    std::thread worker;
+    {
+        mtl::hazard_pointer_domain domain;
+        std::atomic<bool> retired{ false };
+        worker = std::thread([&] {
+            (new Node(1))->retire({}, domain);
+            retired = true;
+            while (!destroyed)
+                std::this_thread::yield();
+        });
+        while (!retired)
+            std::this_thread::yield();
+    }
+    EXPECT_EQ(Node::alive, 0);
+    destroyed = true;
+    worker.join();
+}
+
+TEST(HazardPointerTest, ConcurrentStack) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 2000;
+    {
+        mtl::hazard_pointer_domain domain;
+        Stack stack(domain);
+        std::atomic<long long> popped_sum{ 0 };
+        std::atomic<int> popped{ 0 };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < PER_THREAD; ++i)
+                {
+                    stack.push(t * PER_THREAD + i);
+                    int value;
+                    if (stack.pop(value))
+                    {
+                        popped_sum += value;
+                        ++popped;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        int value;
+        while (stack.pop(value))
+        {
+            popped_sum += value;
+            ++popped;
+        }
+        const long long total = static_cast<long long>(THREADS) * PER_THREAD;
+        EXPECT_EQ(popped, total);
+        EXPECT_EQ(popped_sum, total * (total - 1) / 2);
+    }
+    EXPECT_EQ(Node::alive, 0);
+}
@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include "MTL/HugePageArena.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t HUGE_PAGE = mtl::huge_page_arena::HUGE_PAGE_SIZE;
+
+    bool huge_page_aligned(const void* ptr)
+    {
+        return reinterpret_cast<uintptr_t>(ptr) % HUGE_PAGE == 0;
+    }
+}
+
+TEST(HugePageArenaTest, SmallRequestsShareAChunk) {
+    mtl::huge_page_arena arena;
+    void* first = arena.allocate(100, 8);
+    void* second = arena.allocate(1000, 64);
+
+    EXPECT_TRUE(huge_page_aligned(first));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 64, 0u);
+    EXPECT_EQ(static_cast<std::byte*>(second) - static_cast<std::byte*>(first), 128);
+    EXPECT_EQ(arena.stats().chunks_mapped, 1u);
+
+    // Filling the chunk maps the next one.
+    arena.allocate(HUGE_PAGE / 2 - 1, 1);
+    arena.allocate(HUGE_PAGE / 2 - 1, 1);
+    EXPECT_EQ(arena.stats().chunks_mapped, 2u);
+}
+
+TEST(HugePageArenaTest, LargeRequestsAreMappedAndUnmappedIndividually) {
+    mtl::huge_page_arena arena;
+    void* large = arena.allocate(3 * HUGE_PAGE + 1);
+    EXPECT_TRUE(huge_page_aligned(large));
+    std::memset(large, 0xAB, 3 * HUGE_PAGE + 1);
+
+    mtl::huge_page_stats stats = arena.stats();
+    EXPECT_EQ(stats.chunks_mapped, 1u);
+    EXPECT_EQ(stats.bytes_mapped, 4 * HUGE_PAGE);
+    EXPECT_EQ(stats.explicit_chunks + stats.transparent_chunks + stats.fallback_chunks, 1u);
+
+    arena.deallocate(large, 3 * HUGE_PAGE + 1);
+    EXPECT_EQ(arena.huge_pages_obtained(), 0u);
+}
+
+TEST(HugePageArenaTest, RejectsAlignmentBeyondTheMapping) {
+    mtl::huge_page_arena arena;
+    void* aligned = arena.allocate(64, mtl::huge_page_arena::MAX_ALIGNMENT);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % mtl::huge_page_arena::MAX_ALIGNMENT, 0u);
+    EXPECT_THROW(arena.allocate(64, 2 * mtl::huge_page_arena::MAX_ALIGNMENT), std::bad_alloc);
+    EXPECT_THROW(arena.allocate(4 * HUGE_PAGE, 2 * mtl::huge_page_arena::MAX_ALIGNMENT), std::bad_alloc);
+}
+
+TEST(HugePageArenaTest, FallsBackToPlainPages) {
+    mtl::huge_page_arena arena{ { .allow_explicit = false, .allow_transparent = false } };
+    std::byte* bytes = static_cast<std::byte*>(arena.allocate(2 * HUGE_PAGE));
+    std::memset(bytes, 1, 2 * HUGE_PAGE);
+
+    mtl::huge_page_stats stats = arena.stats();
+    EXPECT_EQ(stats.fallback_chunks, 1u);
+    EXPECT_EQ(stats.explicit_chunks + stats.transparent_chunks, 0u);
+    EXPECT_EQ(arena.huge_pages_obtained(), 0u);
+}
+
+TEST(HugePageArenaTest, ReportsNoMoreHugePagesThanMapped) {
+    mtl::huge_page_arena arena;
+    std::byte* bytes = static_cast<std::byte*>(arena.allocate(8 * HUGE_PAGE));
+    // Touch every page so the kernel has the chance to back them.
+    for (size_t offset = 0; offset < 8 * HUGE_PAGE; offset += 4096)
+        bytes[offset] = std::byte{ 1 };
+
+    mtl::huge_page_stats stats = arena.stats();
+    size_t obtained = arena.huge_pages_obtained();
+    EXPECT_LE(obtained, stats.bytes_mapped / HUGE_PAGE);
+    if (stats.explicit_chunks > 0)
+    {
+        EXPECT_EQ(obtained, 8u);
+    }
+}
+
+TEST(HugePageArenaTest, BacksContainers) {
+    mtl::huge_page_arena arena;
+    mtl::huge_page_allocator<int> alloc{ arena };
+
+    mtl::vector<int, mtl::huge_page_allocator<int>> numbers{ alloc };
+    for (int i = 0; i < 1'000'000; ++i)
+        numbers.push_back(i);
+    for (int i = 0; i < 1'000'000; ++i)
+        ASSERT_EQ(numbers[i], i);
+    EXPECT_EQ(&numbers.get_allocator().arena(), &arena);
+
+    mtl::deque<int, mtl::huge_page_allocator<int>> queue{ alloc };
+    mtl::list<int, mtl::huge_page_allocator<int>> items{ alloc };
+    mtl::basic_string<mtl::huge_page_allocator<char>> text{ alloc };
+    for (int i = 0; i < 1000; ++i)
+    {
+        queue.push_front(i);
+        items.push_back(i);
+        text += "x";
+    }
+    EXPECT_EQ(queue.front(), 999);
+    EXPECT_EQ(items.back(), 999);
+    EXPECT_EQ(text.size(), 1000u);
+
+    mtl::huge_page_stats stats = arena.stats();
+    EXPECT_GT(stats.chunks_mapped, 1u);
+    EXPECT_EQ(stats.explicit_chunks + stats.transparent_chunks + stats.fallback_chunks, stats.chunks_mapped);
+}
+
+TEST(HugePageArenaTest, AllocatorsCompareByArena) {
+    mtl::huge_page_arena first;
+    mtl::huge_page_arena second;
+    mtl::huge_page_allocator<int> a{ first };
+    mtl::huge_page_allocator<double> b{ a };
+
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a == mtl::huge_page_allocator<int>{ second });
+    EXPECT_TRUE(mtl::huge_page_allocator<int>{} == mtl::huge_page_allocator<int>{ mtl::default_huge_page_arena() });
+}
@@ -0,0 +1,157 @@
+#include "gtest/gtest.h"
+#include "MTL/BiasedRefCount.hpp"
+#include "MTL/IntrusivePtr.hpp"
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+    struct Node : mtl::ref_counted<Node>
+    {
+        inline static int alive = 0;
+
+        explicit Node(int value)
+            : value(value)
+        {
+            ++alive;
+        }
+        virtual ~Node()
+        {
+            --alive;
+        }
+        mtl::intrusive_ptr<Node> self()
+        {
+            return mtl::intrusive_ptr<Node>(this);
+        }
+
+        int value;
+        mtl::intrusive_ptr<Node> next;
+    };
+
+    struct Leaf : Node
+    {
+        Leaf()
+            : Node(-1)
+        {
+        }
+    };
+
+    struct SharedNode : mtl::shared_ref_counted<SharedNode>
+    {
+        inline static int alive = 0;
+
+        explicit SharedNode(int value)
+            : value(value)
+        {
+            ++alive;
+        }
+        ~SharedNode()
+        {
+            --alive;
+        }
+
+        int value;
+    };
+
+    struct Small : mtl::ref_counted<Small>
+    {
+        size_t value{ 0 };
+    };
+
+    struct LocalNode : mtl::ref_counted<LocalNode, mtl::local_ref_count>
+    {
+        int value{ 0 };
+    };
+
+    template <typename Policy>
+    concept AcceptedPolicy = requires { typename mtl::ref_counted<Small, Policy>; };
+}
+
+TEST(IntrusivePtrTest, HandleIsOnePointer) {
+    static_assert(sizeof(mtl::intrusive_ptr<Node>) == sizeof(Node*));
+    static_assert(sizeof(mtl::intrusive_ptr<LocalNode>) == sizeof(LocalNode*));
+}
+
+TEST(IntrusivePtrTest, ObjectCarriesOnlyTheCount) {
+    static_assert(!std::is_polymorphic_v<Small>);
+    static_assert(sizeof(Small) == sizeof(mtl::atomic_ref_count) + sizeof(size_t));
+
+    auto small = mtl::make_intrusive<Small>();
+    small->value = 3;
+    auto copy = small;
+    EXPECT_EQ(small->use_count(), 2u);
+    small.reset();
+    EXPECT_EQ(copy->use_count(), 1u);
+}
+
+TEST(IntrusivePtrTest, CountLivesInObject) {
+    Node::alive = 0;
+    {
+        auto head = mtl::make_intrusive<Node>(1);
+        head->next = mtl::make_intrusive<Node>(2);
+        EXPECT_EQ(Node::alive, 2);
+        EXPECT_EQ(head->use_count(), 1u);
+
+        mtl::intrusive_ptr<Node> again = head->self();
+        EXPECT_EQ(again, head);
+        EXPECT_EQ(head->use_count(), 2u);
+
+        mtl::intrusive_ptr<Node> moved = std::move(again);
+        EXPECT_EQ(again.get(), nullptr);
+        EXPECT_EQ(head->use_count(), 2u);
+    }
+    EXPECT_EQ(Node::alive, 0);
+}
+
+TEST(IntrusivePtrTest, DerivedToBase) {
+    Node::alive = 0;
+    {
+        mtl::intrusive_ptr<Leaf> leaf = mtl::make_intrusive<Leaf>();
+        mtl::intrusive_ptr<Node> node = leaf;
+        EXPECT_EQ(node->value, -1);
+        EXPECT_EQ(leaf->use_count(), 2u);
+    }
+    EXPECT_EQ(Node::alive, 0);
+}
+
+TEST(IntrusivePtrTest, FirstReferenceOnAnotherThread) {
+    Node::alive = 0;
+    Node* node = new Node(7);
+    std::thread([node]
+    {
+        mtl::intrusive_ptr<Node> ptr(node);
+        mtl::intrusive_ptr<Node> copy = ptr;
+        EXPECT_EQ(copy->value, 7);
+    }).join();
+    EXPECT_EQ(Node::alive, 0);
+
+    // A biased count would be owned by the constructing thread and leak here.
+    static_assert(AcceptedPolicy<mtl::atomic_ref_count>);
+    static_assert(AcceptedPolicy<mtl::local_ref_count>);
+    static_assert(!AcceptedPolicy<mtl::biased_ref_count>);
+}
+
+TEST(IntrusivePtrTest, LocalPolicy) {
+    auto node = mtl::make_intrusive<LocalNode>();
+    auto copy = node;
+    EXPECT_EQ(node->use_count(), 2u);
+}
+
+TEST(IntrusivePtrTest, ToSharedSharesCount) {
+    SharedNode::alive = 0;
+    mtl::weak_ptr<SharedNode> weak;
+    {
+        auto node = mtl::make_intrusive<SharedNode>(5);
+        mtl::shared_ptr<SharedNode> shared = mtl::to_shared(node);
+        EXPECT_EQ(shared.use_count(), 2u);
+        EXPECT_EQ(node->use_count(), 2u);
+        weak = shared;
+
+        node.reset();
+        EXPECT_EQ(shared.use_count(), 1u);
+        EXPECT_EQ(weak.lock()->value, 5);
+    }
+    EXPECT_TRUE(weak.expired());
+    weak.reset();
+    EXPECT_EQ(SharedNode::alive, 0);
+}
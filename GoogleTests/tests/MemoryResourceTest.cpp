@@ -0,0 +1,231 @@
+#include "gtest/gtest.h"
+#include "MTL/MemoryResource.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    class CountingResource : public mtl::memory_resource
+    {
+    public:
+        size_t allocations{ 0 };
+        size_t outstanding{ 0 };
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            outstanding += bytes;
+            return mtl::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+        {
+            outstanding -= bytes;
+            mtl::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const mtl::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    constexpr const char* LONG_TEXT = "a string that is too long for the small buffer";
+}
+
+TEST(MemoryResourceTest, DefaultResource) {
+    EXPECT_EQ(mtl::get_default_resource(), mtl::new_delete_resource());
+
+    CountingResource counting;
+    mtl::memory_resource* previous = mtl::set_default_resource(&counting);
+    EXPECT_EQ(previous, mtl::new_delete_resource());
+    {
+        mtl::pmr::vector<int> values;
+        values.push_back(1);
+        EXPECT_EQ(counting.allocations, 1u);
+    }
+    mtl::set_default_resource(nullptr);
+    EXPECT_EQ(mtl::get_default_resource(), mtl::new_delete_resource());
+    EXPECT_EQ(counting.outstanding, 0u);
+
+    EXPECT_THROW(mtl::null_memory_resource()->allocate(8), std::bad_alloc);
+}
+
+TEST(MemoryResourceTest, MonotonicBufferUsesInitialBufferFirst) {
+    alignas(std::max_align_t) std::byte buffer[256];
+    CountingResource upstream;
+    mtl::monotonic_buffer_resource arena(buffer, sizeof(buffer), &upstream);
+
+    void* first = arena.allocate(16, 8);
+    void* second = arena.allocate(16, 16);
+    EXPECT_GE(static_cast<std::byte*>(first), buffer);
+    EXPECT_LT(static_cast<std::byte*>(second), buffer + sizeof(buffer));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 16, 0u);
+    EXPECT_EQ(upstream.allocations, 0u);
+
+    arena.allocate(1024);
+    arena.allocate(4096, 64);
+    EXPECT_GT(upstream.allocations, 0u);
+
+    arena.release();
+    EXPECT_EQ(upstream.outstanding, 0u);
+    EXPECT_EQ(arena.allocate(16, 8), first);
+}
+
+TEST(MemoryResourceTest, MonotonicBufferWithNullUpstreamThrowsWhenFull) {
+    alignas(std::max_align_t) std::byte buffer[64];
+    mtl::monotonic_buffer_resource arena(buffer, sizeof(buffer), mtl::null_memory_resource());
+    arena.allocate(64, 1);
+    EXPECT_THROW(arena.allocate(1, 1), std::bad_alloc);
+}
+
+TEST(MemoryResourceTest, PoolRecyclesBlocks) {
+    CountingResource upstream;
+    {
+        mtl::unsynchronized_pool_resource pool(mtl::pool_options{ 64, 256 }, &upstream);
+        EXPECT_EQ(pool.options().largest_required_pool_block, 256u);
+
+        void* first = pool.allocate(24, 8);
+        pool.deallocate(first, 24, 8);
+        EXPECT_EQ(pool.allocate(32, 8), first);
+        size_t chunks = upstream.allocations;
+
+        std::vector<void*> blocks;
+        for (int i = 0; i < 16; ++i)
+            blocks.push_back(pool.allocate(64, 64));
+        for (void* block : blocks)
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % 64, 0u);
+        EXPECT_EQ(upstream.allocations, chunks + 1);
+
+        void* big = pool.allocate(1000);
+        EXPECT_EQ(upstream.allocations, chunks + 2);
+        pool.deallocate(big, 1000);
+        pool.allocate(2000);
+
+        pool.release();
+        EXPECT_EQ(upstream.outstanding, 0u);
+        pool.allocate(8);
+    }
+    EXPECT_EQ(upstream.outstanding, 0u);
+}
+
+TEST(MemoryResourceTest, SynchronizedPoolAcrossThreads) {
+    CountingResource upstream;
+    {
+        mtl::synchronized_pool_resource pool(&upstream);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    mtl::pmr::list<int> values(&pool);
+                    values.push_back(i);
+                    values.push_back(i);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+    EXPECT_EQ(upstream.outstanding, 0u);
+}
+
+TEST(MemoryResourceTest, ContainersAllocateFromResource) {
+    CountingResource counting;
+    {
+        mtl::pmr::vector<int> values({ 1, 2, 3 }, &counting);
+        mtl::pmr::list<int> items({ 1, 2, 3 }, &counting);
+        mtl::pmr::deque<int> queue({ 1, 2, 3 }, &counting);
+        mtl::pmr::string text(LONG_TEXT, &counting);
+        for (int i = 0; i < 100; ++i)
+        {
+            values.push_back(i);
+            items.push_front(i);
+            queue.push_front(i);
+            queue.push_back(i);
+            text += "!";
+        }
+        EXPECT_EQ(values.get_allocator().resource(), &counting);
+        EXPECT_EQ(items.get_allocator().resource(), &counting);
+        EXPECT_EQ(queue.get_allocator().resource(), &counting);
+        EXPECT_EQ(text.get_allocator().resource(), &counting);
+        EXPECT_EQ(queue.size(), 203u);
+        EXPECT_EQ(items.size(), 103u);
+    }
+    EXPECT_GT(counting.allocations, 0u);
+    EXPECT_EQ(counting.outstanding, 0u);
+}
+
+TEST(MemoryResourceTest, ResourcePropagatesToElements) {
+    CountingResource counting;
+    {
+        mtl::pmr::vector<mtl::pmr::string> names(&counting);
+        names.emplace_back(LONG_TEXT);
+        names.push_back(mtl::pmr::string(LONG_TEXT));
+        for (auto& name : names)
+            EXPECT_EQ(name.get_allocator().resource(), &counting);
+
+        mtl::pmr::list<mtl::pmr::vector<int>> rows(&counting);
+        rows.emplace_back();
+        EXPECT_EQ(rows.begin()->get_allocator().resource(), &counting);
+    }
+    EXPECT_EQ(counting.outstanding, 0u);
+}
+
+TEST(MemoryResourceTest, AssignmentKeepsResource) {
+    CountingResource first;
+    CountingResource second;
+    {
+        mtl::pmr::vector<int> a({ 1, 2, 3 }, &first);
+        mtl::pmr::vector<int> b({ 4, 5 }, &second);
+        a = b;
+        EXPECT_EQ(a.get_allocator().resource(), &first);
+        EXPECT_EQ(a.size(), 2u);
+        a = std::move(b);
+        EXPECT_EQ(a.get_allocator().resource(), &first);
+        EXPECT_EQ(a[1], 5);
+
+        mtl::pmr::string s(LONG_TEXT, &first);
+        mtl::pmr::string t(LONG_TEXT, &second);
+        s = std::move(t);
+        EXPECT_EQ(s.get_allocator().resource(), &first);
+        EXPECT_EQ(s, LONG_TEXT);
+
+        mtl::pmr::deque<int> d({ 1 }, &first);
+        d = mtl::pmr::deque<int>({ 2, 3 }, &second);
+        EXPECT_EQ(d.get_allocator().resource(), &first);
+        EXPECT_EQ(d[1], 3);
+
+        mtl::pmr::list<int> l({ 1 }, &first);
+        l = mtl::pmr::list<int>({ 2, 3 }, &second);
+        EXPECT_EQ(l.get_allocator().resource(), &first);
+        EXPECT_EQ(l.back(), 3);
+
+        // Copies start on the default resource, as std::pmr containers do.
+        mtl::pmr::vector<int> copy(a);
+        EXPECT_EQ(copy.get_allocator().resource(), mtl::get_default_resource());
+    }
+    EXPECT_EQ(first.outstanding, 0u);
+    EXPECT_EQ(second.outstanding, 0u);
+}
+
+TEST(MemoryResourceTest, WorkingSetReleasedInOneShot) {
+    CountingResource upstream;
+    mtl::monotonic_buffer_resource arena(&upstream);
+    {
+        mtl::pmr::vector<mtl::pmr::string> names(&arena);
+        mtl::pmr::list<int> items(&arena);
+        for (int i = 0; i < 100; ++i)
+        {
+            names.emplace_back(LONG_TEXT);
+            items.push_back(i);
+        }
+    }
+    EXPECT_GT(upstream.outstanding, 0u);
+    arena.release();
+    EXPECT_EQ(upstream.outstanding, 0u);
+}
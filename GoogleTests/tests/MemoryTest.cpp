@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "MTL/Memory.hpp"
 #include <memory>
+#include <thread>
+#include <vector>
 
 struct RefCounter 
 {
@@ -117,4 +119,464 @@ TEST(SharedPtrTest, AssignmentOperator) {
     EXPECT_EQ(ptr1.use_count(), 2);
     EXPECT_EQ(ptr2.use_count(), 2);
     EXPECT_EQ(*ptr2, 5);
-}
\ No newline at end of file
+}
+
+TEST(WeakPtrTest, LockAndExpired) {
+    mtl::weak_ptr<int> weak;
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(weak.lock().get(), nullptr);
+    {
+        mtl::shared_ptr<int> ptr = mtl::make_shared<int>(7);
+        weak = ptr;
+        EXPECT_FALSE(weak.expired());
+        EXPECT_EQ(weak.use_count(), 1);
+
+        mtl::shared_ptr<int> locked = weak.lock();
+        ASSERT_NE(locked.get(), nullptr);
+        EXPECT_EQ(*locked, 7);
+        EXPECT_EQ(ptr.use_count(), 2);
+    }
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(weak.lock().get(), nullptr);
+}
+
+TEST(WeakPtrTest, ObjectDestroyedBeforeStorage) {
+    RefCounter::count = 0;
+    mtl::weak_ptr<RefCounter> weak;
+    {
+        auto ptr = mtl::make_shared<RefCounter>();
+        weak = ptr;
+        EXPECT_EQ(RefCounter::count, 1);
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+    EXPECT_TRUE(weak.expired());
+
+    mtl::shared_ptr<RefCounter> adopted(new RefCounter());
+    mtl::weak_ptr<RefCounter> weak_adopted = adopted;
+    adopted.reset();
+    EXPECT_EQ(RefCounter::count, 0);
+    EXPECT_TRUE(weak_adopted.expired());
+}
+
+TEST(WeakPtrTest, ConstructSharedFromExpired) {
+    mtl::weak_ptr<int> weak;
+    {
+        mtl::shared_ptr<int> ptr(new int(1));
+        weak = ptr;
+        mtl::shared_ptr<int> from_weak(weak);
+        EXPECT_EQ(ptr.use_count(), 2);
+    }
+    EXPECT_THROW(mtl::shared_ptr<int>{ weak }, mtl::bad_weak_ptr);
+}
+
+struct SelfAware : mtl::enable_shared_from_this<SelfAware>
+{
+    int value{ 3 };
+};
+
+TEST(EnableSharedFromThisTest, SharesOwnership) {
+    auto ptr = mtl::make_shared<SelfAware>();
+    mtl::shared_ptr<SelfAware> self = ptr->shared_from_this();
+    EXPECT_EQ(self.get(), ptr.get());
+    EXPECT_EQ(ptr.use_count(), 2);
+
+    mtl::shared_ptr<SelfAware> adopted(new SelfAware());
+    EXPECT_EQ(adopted->shared_from_this().get(), adopted.get());
+    EXPECT_EQ(adopted->weak_from_this().use_count(), 1);
+
+    SelfAware unowned;
+    EXPECT_TRUE(unowned.weak_from_this().expired());
+    EXPECT_THROW(unowned.shared_from_this(), mtl::bad_weak_ptr);
+}
+
+struct AllocationLog
+{
+    int allocations{ 0 };
+    int deallocations{ 0 };
+};
+
+template <typename T>
+struct LoggingAllocator
+{
+    using value_type = T;
+
+    explicit LoggingAllocator(AllocationLog* log)
+        : log(log)
+    {
+    }
+    template <typename U>
+    LoggingAllocator(const LoggingAllocator<U>& rhs)
+        : log(rhs.log)
+    {
+    }
+    T* allocate(size_t n)
+    {
+        ++log->allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* ptr, size_t n)
+    {
+        ++log->deallocations;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+    template <typename U>
+    friend bool operator==(const LoggingAllocator& lhs, const LoggingAllocator<U>& rhs)
+    {
+        return lhs.log == rhs.log;
+    }
+
+    AllocationLog* log;
+};
+
+TEST(AllocateSharedTest, SingleAllocationThroughAllocator) {
+    AllocationLog log;
+    RefCounter::count = 0;
+    mtl::weak_ptr<RefCounter> weak;
+    {
+        auto ptr = mtl::allocate_shared<RefCounter>(LoggingAllocator<int>(&log));
+        EXPECT_EQ(log.allocations, 1);
+        EXPECT_EQ(RefCounter::count, 1);
+        weak = ptr;
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+    EXPECT_EQ(log.deallocations, 0);
+    weak.reset();
+    EXPECT_EQ(log.deallocations, 1);
+}
+
+TEST(AllocateSharedTest, ForwardsArguments) {
+    AllocationLog log;
+    auto ptr = mtl::allocate_shared<std::pair<int, double>>(LoggingAllocator<char>(&log), 4, 2.5);
+    EXPECT_EQ(ptr->first, 4);
+    EXPECT_EQ(ptr->second, 2.5);
+    EXPECT_EQ(ptr.use_count(), 1);
+}
+
+struct CountingDeleter
+{
+    inline static int calls = 0;
+    void operator()(RefCounter* ptr) const
+    {
+        ++calls;
+        delete ptr;
+    }
+};
+
+TEST(UniquePtrTest, StatelessDeleterIsFree) {
+    auto lambda_deleter = [](int* ptr) { delete ptr; };
+    static_assert(sizeof(mtl::unique_ptr<int>) == sizeof(int*));
+    static_assert(sizeof(mtl::unique_ptr<int[]>) == sizeof(int*));
+    static_assert(sizeof(mtl::unique_ptr<RefCounter, CountingDeleter>) == sizeof(RefCounter*));
+    static_assert(sizeof(mtl::unique_ptr<int, decltype(lambda_deleter)>) == sizeof(int*));
+    static_assert(sizeof(mtl::unique_ptr<int, void(*)(int*)>) == 2 * sizeof(int*));
+
+    mtl::unique_ptr<int, decltype(lambda_deleter)> ptr(new int(3), lambda_deleter);
+    EXPECT_EQ(*ptr, 3);
+}
+
+TEST(UniquePtrTest, CustomDeleter) {
+    RefCounter::count = 0;
+    CountingDeleter::calls = 0;
+    {
+        mtl::unique_ptr<RefCounter, CountingDeleter> ptr(new RefCounter());
+        mtl::unique_ptr<RefCounter, CountingDeleter> moved = std::move(ptr);
+        moved.reset(new RefCounter());
+        EXPECT_EQ(CountingDeleter::calls, 1);
+        EXPECT_EQ(RefCounter::count, 1);
+    }
+    EXPECT_EQ(CountingDeleter::calls, 2);
+    EXPECT_EQ(RefCounter::count, 0);
+}
+
+TEST(UniquePtrTest, StatefulDeleter) {
+    int released = 0;
+    auto deleter = [&released](int* ptr) { ++released; delete ptr; };
+    {
+        mtl::unique_ptr<int, decltype(deleter)> ptr(new int(1), deleter);
+    }
+    EXPECT_EQ(released, 1);
+}
+
+TEST(SharedPtrTest, CustomDeleter) {
+    RefCounter::count = 0;
+    CountingDeleter::calls = 0;
+    {
+        mtl::shared_ptr<RefCounter> ptr(new RefCounter(), CountingDeleter());
+        mtl::shared_ptr<RefCounter> copy = ptr;
+        EXPECT_EQ(ptr.use_count(), 2);
+    }
+    EXPECT_EQ(CountingDeleter::calls, 1);
+    EXPECT_EQ(RefCounter::count, 0);
+
+    int buffer = 5;
+    bool released = false;
+    {
+        mtl::shared_ptr<int> ptr(&buffer, [&released](int*) { released = true; });
+        EXPECT_EQ(*ptr, 5);
+    }
+    EXPECT_TRUE(released);
+}
+
+TEST(SharedPtrTest, FromUniquePtr) {
+    RefCounter::count = 0;
+    CountingDeleter::calls = 0;
+    {
+        mtl::unique_ptr<RefCounter, CountingDeleter> unique(new RefCounter());
+        mtl::shared_ptr<RefCounter> shared(std::move(unique));
+        EXPECT_EQ(unique.get(), nullptr);
+        EXPECT_EQ(shared.use_count(), 1);
+    }
+    EXPECT_EQ(CountingDeleter::calls, 1);
+    EXPECT_EQ(RefCounter::count, 0);
+}
+
+TEST(MakeSharedArrayTest, UnboundedArray) {
+    RefCounter::count = 0;
+    {
+        mtl::shared_ptr<RefCounter[]> arr = mtl::make_shared<RefCounter[]>(4);
+        EXPECT_EQ(RefCounter::count, 4);
+        EXPECT_EQ(arr.use_count(), 1);
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+
+    auto ints = mtl::make_shared<int[]>(8);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(ints[i], 0);
+        ints[i] = i;
+    }
+    EXPECT_EQ(ints[7], 7);
+
+    mtl::shared_ptr<RefCounter[]> adopted(new RefCounter[2]);
+    EXPECT_EQ(RefCounter::count, 2);
+    adopted.reset();
+    EXPECT_EQ(RefCounter::count, 0);
+}
+
+TEST(MakeSharedArrayTest, BoundedArray) {
+    auto arr = mtl::make_shared<double[3]>();
+    EXPECT_EQ(arr[0], 0.0);
+    arr[2] = 1.5;
+    EXPECT_EQ(arr[2], 1.5);
+}
+
+TEST(MakeSharedArrayTest, ElementsAreAligned) {
+    struct alignas(64) Wide
+    {
+        char bytes[64];
+    };
+    auto arr = mtl::make_shared<Wide[]>(3);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(arr.get()) % 64, 0);
+}
+
+TEST(MakeSharedArrayTest, SingleAllocation) {
+    AllocationLog log;
+    RefCounter::count = 0;
+    {
+        auto arr = mtl::allocate_shared<RefCounter[]>(LoggingAllocator<int>(&log), 16);
+        EXPECT_EQ(log.allocations, 1);
+        EXPECT_EQ(RefCounter::count, 16);
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+    EXPECT_EQ(log.deallocations, 1);
+}
+
+TEST(MakeSharedArrayTest, HugeSizesThrowBeforeAllocating) {
+    EXPECT_THROW(mtl::make_shared<uint32_t[]>(SIZE_MAX / 4 + 2), std::bad_array_new_length);
+    EXPECT_THROW(mtl::make_shared_for_overwrite<RefCounter[]>(SIZE_MAX), std::bad_array_new_length);
+
+    AllocationLog log;
+    EXPECT_THROW(mtl::allocate_shared<uint64_t[]>(LoggingAllocator<int>(&log), SIZE_MAX / 8), std::bad_array_new_length);
+    EXPECT_EQ(log.allocations, 0);
+}
+
+TEST(MakeSharedArrayTest, ForOverwrite) {
+    RefCounter::count = 0;
+    {
+        auto objects = mtl::make_shared_for_overwrite<RefCounter[]>(5);
+        EXPECT_EQ(RefCounter::count, 5);
+        auto fixed = mtl::make_shared_for_overwrite<RefCounter[2]>();
+        EXPECT_EQ(RefCounter::count, 7);
+        auto single = mtl::make_shared_for_overwrite<RefCounter>();
+        EXPECT_EQ(RefCounter::count, 8);
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+
+    auto buffer = mtl::make_shared_for_overwrite<char[]>(1024);
+    buffer[1023] = 'x';
+    EXPECT_EQ(buffer[1023], 'x');
+}
+
+TEST(MakeSharedArrayTest, WeakKeepsStorage) {
+    RefCounter::count = 0;
+    mtl::weak_ptr<RefCounter[]> weak;
+    {
+        auto arr = mtl::make_shared<RefCounter[]>(3);
+        weak = arr;
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(UniquePtrTest, MakeUniqueForOverwrite) {
+    RefCounter::count = 0;
+    {
+        auto single = mtl::make_unique_for_overwrite<RefCounter>();
+        auto arr = mtl::make_unique_for_overwrite<RefCounter[]>(3);
+        EXPECT_EQ(RefCounter::count, 4);
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+
+    auto buffer = mtl::make_unique_for_overwrite<char[]>(64);
+    std::fill_n(buffer.get(), 64, 'z');
+    EXPECT_EQ(buffer[63], 'z');
+}
+
+TEST(LocalSharedPtrTest, CountsAndLifetime) {
+    RefCounter::count = 0;
+    mtl::local_weak_ptr<RefCounter> weak;
+    {
+        mtl::local_shared_ptr<RefCounter> ptr = mtl::make_local_shared<RefCounter>();
+        mtl::local_shared_ptr<RefCounter> copy = ptr;
+        weak = copy;
+        EXPECT_EQ(ptr.use_count(), 2);
+        EXPECT_EQ(weak.lock().get(), ptr.get());
+        EXPECT_EQ(RefCounter::count, 1);
+    }
+    EXPECT_EQ(RefCounter::count, 0);
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(LocalSharedPtrTest, SharesSingleAllocationLayout) {
+    AllocationLog log;
+    {
+        auto ptr = mtl::allocate_shared<int, mtl::local_ref_count>(LoggingAllocator<int>(&log), 9);
+        EXPECT_EQ(*ptr, 9);
+        auto arr = mtl::make_local_shared<int[]>(4);
+        EXPECT_EQ(arr[3], 0);
+        mtl::local_shared_ptr<int> adopted(new int(2));
+        EXPECT_EQ(adopted.use_count(), 1);
+    }
+    EXPECT_EQ(log.allocations, 1);
+    EXPECT_EQ(log.deallocations, 1);
+}
+
+struct Base
+{
+    virtual ~Base() = default;
+    int base_value{ 1 };
+};
+
+struct Derived : Base
+{
+    int derived_value{ 2 };
+};
+
+struct Composite
+{
+    int header{ 10 };
+    double payload[4]{ 1.0, 2.0, 3.0, 4.0 };
+};
+
+TEST(SharedPtrTest, AliasingSharesControlBlock) {
+    auto whole = mtl::make_shared<Composite>();
+    mtl::shared_ptr<double> element(whole, &whole->payload[2]);
+    EXPECT_EQ(*element, 3.0);
+    EXPECT_EQ(whole.use_count(), 2);
+
+    mtl::weak_ptr<Composite> weak = whole;
+    whole.reset();
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ(*element, 3.0);
+
+    mtl::shared_ptr<int> header(std::move(element), &weak.lock()->header);
+    EXPECT_EQ(element.get(), nullptr);
+    EXPECT_EQ(header.use_count(), 1);
+    header.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(SharedPtrTest, UpcastConversions) {
+    RefCounter::count = 0;
+    mtl::shared_ptr<Derived> derived = mtl::make_shared<Derived>();
+    mtl::shared_ptr<Base> base = derived;
+    EXPECT_EQ(base.get(), derived.get());
+    EXPECT_EQ(derived.use_count(), 2);
+
+    mtl::shared_ptr<const Base> moved = std::move(base);
+    EXPECT_EQ(base.get(), nullptr);
+    EXPECT_EQ(derived.use_count(), 2);
+
+    mtl::weak_ptr<Base> weak = derived;
+    mtl::weak_ptr<const Base> const_weak = weak;
+    EXPECT_EQ(const_weak.lock().get(), derived.get());
+
+    base = derived;
+    EXPECT_EQ(derived.use_count(), 3);
+}
+
+TEST(SharedPtrTest, PointerCasts) {
+    mtl::shared_ptr<Base> base = mtl::make_shared<Derived>();
+
+    auto derived = mtl::static_pointer_cast<Derived>(base);
+    EXPECT_EQ(derived->derived_value, 2);
+    EXPECT_EQ(base.use_count(), 2);
+
+    auto checked = mtl::dynamic_pointer_cast<Derived>(base);
+    EXPECT_EQ(checked.get(), derived.get());
+    EXPECT_EQ(base.use_count(), 3);
+
+    mtl::shared_ptr<Base> plain = mtl::make_shared<Base>();
+    EXPECT_EQ(mtl::dynamic_pointer_cast<Derived>(plain).get(), nullptr);
+    EXPECT_EQ(plain.use_count(), 1);
+
+    mtl::shared_ptr<const Base> constant = base;
+    mtl::shared_ptr<Base> mutable_again = mtl::const_pointer_cast<Base>(constant);
+    mutable_again->base_value = 7;
+    EXPECT_EQ(base->base_value, 7);
+
+    auto bytes = mtl::reinterpret_pointer_cast<unsigned char>(mtl::make_shared<int>(0));
+    EXPECT_EQ(*bytes, 0);
+
+    auto moved = mtl::static_pointer_cast<Derived>(std::move(base));
+    EXPECT_EQ(base.get(), nullptr);
+    EXPECT_EQ(moved.use_count(), 5);
+}
+
+struct ConstSelf : mtl::enable_shared_from_this<ConstSelf>
+{
+};
+
+TEST(EnableSharedFromThisTest, ConstAccess) {
+    mtl::shared_ptr<const ConstSelf> ptr = mtl::make_shared<ConstSelf>();
+    mtl::shared_ptr<const ConstSelf> self = ptr->shared_from_this();
+    EXPECT_EQ(self.get(), ptr.get());
+    EXPECT_EQ(ptr.use_count(), 2);
+}
+
+TEST(SharedPtrTest, AdoptionSteadyStateUsesPool) {
+    for (int i = 0; i < 1000; ++i) {
+        mtl::shared_ptr<int> warm(new int(i));
+    }
+    mtl::block_pool_stats before = mtl::control_block_pool_stats();
+    for (int i = 0; i < 100000; ++i) {
+        mtl::shared_ptr<int> ptr(new int(i));
+        mtl::shared_ptr<int> copy = ptr;
+    }
+    mtl::block_pool_stats after = mtl::control_block_pool_stats();
+    EXPECT_EQ(after.slab_allocations, before.slab_allocations);
+    EXPECT_GT(after.bytes_reserved, 0u);
+}
+
+TEST(SharedPtrTest, AdoptedBlocksFreedAcrossThreads) {
+    RefCounter::count = 0;
+    constexpr int COUNT = 1000;
+    std::vector<mtl::shared_ptr<RefCounter>> handed_off;
+    for (int i = 0; i < COUNT; ++i)
+        handed_off.emplace_back(new RefCounter());
+
+    std::thread([&] { handed_off.clear(); }).join();
+    EXPECT_EQ(RefCounter::count, 0);
+
+    mtl::block_pool_stats stats = mtl::control_block_pool_stats();
+    EXPECT_GT(stats.batches_returned, 0u);
+}
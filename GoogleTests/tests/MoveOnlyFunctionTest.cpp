@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+#include "MTL/Deque.hpp"
+#include "MTL/Memory.hpp"
+#include "MTL/MoveOnlyFunction.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    struct Tracked
+    {
+        static inline int alive = 0;
+        static inline int moves = 0;
+
+        Tracked()
+        {
+            ++alive;
+        }
+        Tracked(Tracked&&) noexcept
+        {
+            ++alive;
+            ++moves;
+        }
+        ~Tracked()
+        {
+            --alive;
+        }
+        int operator()(int value)
+        {
+            return value + 1;
+        }
+    };
+
+    struct Large
+    {
+        char padding[256]{};
+        int operator()(int value)
+        {
+            return value + padding[0];
+        }
+    };
+
+    template <size_t N>
+    struct Bytes
+    {
+        char data[N];
+    };
+
+    int twice(int value)
+    {
+        return value * 2;
+    }
+
+    // Minimal single-worker executor with move_only_function as its task type.
+    class Worker
+    {
+    public:
+        using task = mtl::move_only_function<void()>;
+
+        Worker()
+            : m_Thread([this] { Run(); })
+        {
+        }
+        ~Worker()
+        {
+            submit(task{});
+            m_Thread.join();
+        }
+        void submit(task job)
+        {
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Tasks.push_back(std::move(job));
+            }
+            m_Wakeup.notify_one();
+        }
+
+    private:
+        void Run()
+        {
+            while (true)
+            {
+                task job;
+                {
+                    std::unique_lock lock(m_Mutex);
+                    m_Wakeup.wait(lock, [this] { return !m_Tasks.empty(); });
+                    job = std::move(m_Tasks.front());
+                    m_Tasks.pop_front();
+                }
+                if (!job)
+                    return;
+                job();
+            }
+        }
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Wakeup;
+        mtl::deque<task> m_Tasks;
+        std::thread m_Thread;
+    };
+}
+
+TEST(MoveOnlyFunctionTest, HoldsMoveOnlyCaptures) {
+    mtl::unique_ptr<int> value(new int(41));
+    mtl::move_only_function<int()> func = [value = std::move(value)] { return *value + 1; };
+    ASSERT_TRUE(func);
+    EXPECT_EQ(func(), 42);
+
+    mtl::move_only_function<int()> moved = std::move(func);
+    EXPECT_FALSE(func);
+    EXPECT_EQ(moved(), 42);
+}
+
+TEST(MoveOnlyFunctionTest, EmptyStates) {
+    mtl::move_only_function<void()> empty;
+    EXPECT_TRUE(empty == nullptr);
+    EXPECT_THROW(empty(), std::bad_function_call);
+
+    int (*null_function)(int) = nullptr;
+    mtl::move_only_function<int(int)> from_null = null_function;
+    EXPECT_FALSE(from_null);
+
+    mtl::move_only_function<int(int)> from_pointer = &twice;
+    EXPECT_EQ(from_pointer(4), 8);
+    from_pointer = nullptr;
+    EXPECT_FALSE(from_pointer);
+}
+
+TEST(MoveOnlyFunctionTest, SmallCallablesStayInline) {
+    using function = mtl::move_only_function<int(int)>;
+    static_assert(sizeof(function) == 5 * sizeof(void*) + 3 * sizeof(void*));
+    static_assert(function::fits_inline<Tracked>);
+    static_assert(function::fits_inline<mtl::unique_ptr<int>>);
+    static_assert(!function::fits_inline<Large>);
+    static_assert(mtl::move_only_function<int(int), 8 * sizeof(void*)>::fits_inline<Bytes<64>>);
+    static_assert(!mtl::move_only_function<int(int), 2 * sizeof(void*)>::fits_inline<Bytes<17>>);
+
+    Large large;
+    large.padding[0] = 5;
+    function big = large;
+    function moved = std::move(big);
+    EXPECT_EQ(moved(1), 6);
+}
+
+TEST(MoveOnlyFunctionTest, ManagesLifetimeOfNonTrivialCallables) {
+    Tracked::alive = 0;
+    Tracked::moves = 0;
+    {
+        mtl::move_only_function<int(int)> func{ std::in_place_type<Tracked> };
+        EXPECT_EQ(Tracked::alive, 1);
+        EXPECT_EQ(Tracked::moves, 0);
+
+        mtl::move_only_function<int(int)> moved = std::move(func);
+        EXPECT_EQ(Tracked::alive, 1);
+        EXPECT_EQ(Tracked::moves, 1);
+        EXPECT_EQ(moved(1), 2);
+
+        func = std::move(moved);
+        EXPECT_EQ(func(2), 3);
+        func = nullptr;
+        EXPECT_EQ(Tracked::alive, 0);
+
+        func = Tracked{};
+        swap(func, moved);
+        EXPECT_FALSE(func);
+        EXPECT_EQ(moved(3), 4);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(MoveOnlyFunctionTest, ForwardsArgumentsAndResults) {
+    mtl::move_only_function<mtl::string(mtl::string&&, const mtl::string&)> join =
+        [](mtl::string&& lhs, const mtl::string& rhs) { return std::move(lhs) + rhs; };
+    mtl::string tail("tail");
+    EXPECT_STREQ(join(mtl::string("head-"), tail).c_str(), "head-tail");
+
+    mtl::move_only_function<long(int) noexcept> widen = [](int value) noexcept { return value; };
+    static_assert(noexcept(widen(1)));
+    EXPECT_EQ(widen(7), 7L);
+
+    struct Point
+    {
+        int x;
+    };
+    mtl::move_only_function<int(Point&)> member = &Point::x;
+    Point point{ 3 };
+    EXPECT_EQ(member(point), 3);
+}
+
+TEST(MoveOnlyFunctionTest, ContainersRelocateStoredTasks) {
+    Tracked::alive = 0;
+    mtl::vector<mtl::move_only_function<int()>> tasks;
+    for (int i = 0; i < 100; ++i)
+    {
+        if (i % 2)
+            tasks.emplace_back([value = mtl::unique_ptr<int>(new int(i))] { return *value; });
+        else
+            tasks.emplace_back([i, tracked = Tracked{}] { return i; });
+    }
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(tasks[i](), i);
+    EXPECT_EQ(Tracked::alive, 50);
+    tasks.clear();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(MoveOnlyFunctionTest, WorksAsExecutorTaskType) {
+    std::atomic<int> sum{ 0 };
+    {
+        Worker worker;
+        for (int i = 1; i <= 100; ++i)
+            worker.submit([&sum, value = mtl::make_shared<int>(i)] { sum += *value; });
+    }
+    EXPECT_EQ(sum.load(), 5050);
+}
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+#include "MTL/ObjectPool.hpp"
+#include "MTL/Vector.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Buffer
+    {
+        inline static std::atomic<int> alive{ 0 };
+
+        Buffer()
+        {
+            ++alive;
+        }
+        ~Buffer()
+        {
+            --alive;
+        }
+        void clear()
+        {
+            ++clears;
+            size = 0;
+        }
+
+        int clears{ 0 };
+        size_t size{ 0 };
+    };
+
+    struct Counter
+    {
+        int value{ 0 };
+    };
+
+    struct ZeroCounter
+    {
+        void operator()(Counter& counter) const
+        {
+            counter.value = 0;
+        }
+    };
+}
+
+TEST(ObjectPoolTest, ReleasedObjectIsResetAndReused) {
+    {
+        mtl::object_pool<Buffer> pool;
+        Buffer* first = nullptr;
+        {
+            auto buffer = pool.acquire();
+            buffer->size = 42;
+            first = buffer.get();
+        }
+        EXPECT_EQ(Buffer::alive, 1);
+
+        auto again = pool.acquire();
+        EXPECT_EQ(again.get(), first);
+        EXPECT_EQ(again->size, 0u);
+        EXPECT_EQ(again->clears, 1);
+        EXPECT_EQ(pool.created(), 1u);
+    }
+    EXPECT_EQ(Buffer::alive, 0);
+}
+
+TEST(ObjectPoolTest, CustomReset) {
+    mtl::object_pool<Counter, ZeroCounter> pool;
+    {
+        auto counter = pool.acquire();
+        counter->value = 5;
+    }
+    EXPECT_EQ(pool.acquire()->value, 0);
+}
+
+TEST(ObjectPoolTest, ResetMemberIsPreferred) {
+    mtl::object_pool<mtl::unique_ptr<int>> pool;
+    {
+        auto slot = pool.acquire();
+        *slot = mtl::make_unique<int>(3);
+    }
+    EXPECT_EQ(pool.acquire()->get(), nullptr);
+}
+
+TEST(ObjectPoolTest, OverflowListFeedsOtherThreads) {
+    {
+        mtl::object_pool<Buffer> pool(4);
+        {
+            mtl::vector<mtl::object_pool<Buffer>::handle> handles;
+            for (int i = 0; i < 10; ++i)
+                handles.push_back(pool.acquire());
+        }
+        EXPECT_EQ(pool.created(), 10u);
+
+        // This thread's cache holds at most 4; the rest went to the overflow list.
+        std::thread([&] {
+            auto first = pool.acquire();
+            auto second = pool.acquire();
+        }).join();
+        EXPECT_EQ(pool.created(), 10u);
+    }
+    EXPECT_EQ(Buffer::alive, 0);
+}
+
+TEST(ObjectPoolTest, ConcurrentAcquireRelease) {
+    {
+        mtl::object_pool<Buffer> pool(8);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    auto first = pool.acquire();
+                    auto second = pool.acquire();
+                    first->size = second->size = 1;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        EXPECT_LE(pool.created(), 8u);
+        EXPECT_EQ(Buffer::alive, static_cast<int>(pool.created()));
+    }
+    EXPECT_EQ(Buffer::alive, 0);
+}
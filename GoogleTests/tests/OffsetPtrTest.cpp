@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include "MTL/OffsetPtr.hpp"
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace
+{
+    struct Base
+    {
+        int value{ 0 };
+    };
+    struct Derived : Base
+    {
+    };
+
+    // A node that links to its neighbour through an offset_ptr.
+    struct Link
+    {
+        int value;
+        mtl::offset_ptr<Link> next;
+    };
+}
+
+TEST(OffsetPtrTest, NullAndSelfReferenceAreDistinct) {
+    mtl::offset_ptr<int> empty;
+    EXPECT_FALSE(empty);
+    EXPECT_EQ(empty.get(), nullptr);
+    EXPECT_TRUE(empty == nullptr);
+
+    struct Self
+    {
+        mtl::offset_ptr<Self> self{ this };
+    } self;
+    EXPECT_TRUE(self.self);
+    EXPECT_EQ(self.self.get(), &self);
+}
+
+TEST(OffsetPtrTest, CopiesPointAtTheSameTarget) {
+    int value = 42;
+    mtl::offset_ptr<int> first{ &value };
+    auto second = std::make_unique<mtl::offset_ptr<int>>(first);
+
+    EXPECT_EQ(second->get(), &value);
+    EXPECT_EQ(**second, 42);
+    EXPECT_TRUE(first == *second);
+
+    mtl::offset_ptr<int> third;
+    third = *second;
+    EXPECT_EQ(third.get(), &value);
+}
+
+TEST(OffsetPtrTest, SurvivesRelocationTogetherWithItsTarget) {
+    alignas(Link) std::byte original[2 * sizeof(Link)];
+    Link* links = ::new (original) Link[2]{ { 1, nullptr }, { 2, nullptr } };
+    links[0].next = &links[1];
+
+    // A byte copy models the same memory mapped at another address.
+    alignas(Link) std::byte moved[2 * sizeof(Link)];
+    std::memcpy(moved, original, sizeof(original));
+    Link* relocated = std::launder(reinterpret_cast<Link*>(moved));
+
+    EXPECT_EQ(relocated[0].next.get(), &relocated[1]);
+    EXPECT_EQ(relocated[0].next->value, 2);
+    EXPECT_FALSE(relocated[1].next);
+}
+
+TEST(OffsetPtrTest, SupportsPointerArithmetic) {
+    int values[]{ 10, 20, 30, 40 };
+    mtl::offset_ptr<int> it{ values };
+
+    EXPECT_EQ(it[2], 30);
+    EXPECT_EQ(*(it + 3), 40);
+    ++it;
+    EXPECT_EQ(*it, 20);
+    it += 2;
+    EXPECT_EQ(*it, 40);
+    EXPECT_EQ(it - mtl::offset_ptr<int>{ values }, 3);
+    EXPECT_TRUE(mtl::offset_ptr<int>{ values } < it);
+    --it;
+    EXPECT_EQ(*it--, 30);
+    EXPECT_EQ(*it, 20);
+}
+
+TEST(OffsetPtrTest, ConvertsLikeRawPointers) {
+    Derived derived;
+    mtl::offset_ptr<Derived> derived_ptr{ &derived };
+    mtl::offset_ptr<Base> base_ptr{ derived_ptr };
+    mtl::offset_ptr<const Base> const_ptr{ base_ptr };
+    EXPECT_EQ(const_ptr.get(), &derived);
+
+    mtl::offset_ptr<void> erased{ derived_ptr };
+    mtl::offset_ptr<Derived> restored{ erased };
+    EXPECT_EQ(restored.get(), &derived);
+
+    using traits = std::pointer_traits<mtl::offset_ptr<Derived>>;
+    static_assert(std::is_same_v<traits::rebind<int>, mtl::offset_ptr<int>>);
+    EXPECT_EQ(traits::pointer_to(derived).get(), &derived);
+    EXPECT_EQ(std::to_address(derived_ptr), &derived);
+}
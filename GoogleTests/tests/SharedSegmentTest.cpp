@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+#include "MTL/SharedSegment.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    template <typename T>
+    using shm_vector = mtl::vector<T, mtl::segment_allocator<T>>;
+    template <typename T>
+    using shm_list = mtl::list<T, mtl::segment_allocator<T>>;
+    template <typename T>
+    using shm_deque = mtl::deque<T, mtl::segment_allocator<T>>;
+    using shm_string = mtl::basic_string<mtl::segment_allocator<char>>;
+
+    constexpr size_t SEGMENT_SIZE = 4 * 1024 * 1024;
+
+    // Creates a uniquely named segment and removes the name afterwards.
+    struct ScopedSegment
+    {
+        std::string name;
+        mtl::shared_segment segment;
+
+        ScopedSegment()
+            : name(UniqueName()), segment(mtl::shared_segment::create, name, SEGMENT_SIZE)
+        {
+        }
+        ~ScopedSegment()
+        {
+            mtl::shared_segment::remove(name);
+        }
+
+        static std::string UniqueName()
+        {
+            static std::atomic<int> counter{ 0 };
+            return "mtl_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())
+                + "_" + std::to_string(counter++);
+        }
+    };
+}
+
+TEST(SharedSegmentTest, FreedBlocksCoalesce) {
+    ScopedSegment scoped;
+    mtl::shared_segment& segment = scoped.segment;
+    size_t initial = segment.free_bytes();
+
+    void* blocks[8];
+    for (size_t i = 0; i < 8; ++i)
+    {
+        blocks[i] = segment.allocate(1000 * (i + 1));
+        EXPECT_TRUE(segment.contains(blocks[i]));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(blocks[i]) % 16, 0u);
+    }
+    EXPECT_LT(segment.free_bytes(), initial);
+
+    for (size_t i : { 3, 0, 7, 5, 1, 6, 2, 4 })
+        segment.deallocate(blocks[i]);
+    EXPECT_EQ(segment.free_bytes(), initial);
+
+    // Only a fully coalesced heap can serve one block of everything.
+    void* everything = segment.allocate(initial - 16);
+    EXPECT_EQ(segment.free_bytes(), 0u);
+    EXPECT_THROW(segment.allocate(1), std::bad_alloc);
+    segment.deallocate(everything);
+}
+
+TEST(SharedSegmentTest, NamedObjects) {
+    ScopedSegment scoped;
+    mtl::shared_segment& segment = scoped.segment;
+
+    int* answer = segment.construct<int>("answer", 42);
+    EXPECT_TRUE(segment.contains(answer));
+    EXPECT_EQ(segment.find<int>("answer"), answer);
+    EXPECT_EQ(segment.find<int>("question"), nullptr);
+    EXPECT_THROW(segment.construct<int>("answer", 7), std::runtime_error);
+    EXPECT_THROW(segment.construct<int>(std::string(100, 'x'), 7), std::invalid_argument);
+
+    EXPECT_TRUE(segment.destroy<int>("answer"));
+    EXPECT_FALSE(segment.destroy<int>("answer"));
+    EXPECT_EQ(segment.find<int>("answer"), nullptr);
+}
+
+TEST(SharedSegmentTest, OpeningAMissingSegmentFails) {
+    EXPECT_THROW(mtl::shared_segment(mtl::shared_segment::open, ScopedSegment::UniqueName()), std::system_error);
+}
+
+TEST(SharedSegmentTest, ContainersAreReadInPlaceFromAnotherMapping) {
+    ScopedSegment scoped;
+    mtl::shared_segment& producer = scoped.segment;
+    mtl::segment_allocator<int> alloc{ producer };
+
+    auto* numbers = producer.construct<shm_vector<int>>("numbers", alloc);
+    auto* items = producer.construct<shm_list<int>>("items", alloc);
+    auto* queue = producer.construct<shm_deque<int>>("queue", alloc);
+    auto* text = producer.construct<shm_string>("text", "a string long enough for the heap", alloc);
+    for (int i = 0; i < 1000; ++i)
+    {
+        numbers->push_back(i);
+        items->push_back(i);
+        queue->push_front(i);
+    }
+
+    // A second mapping of the same segment sits at a different address, the
+    // way it would in a consumer process.
+    mtl::shared_segment consumer{ mtl::shared_segment::open, scoped.name };
+    ASSERT_NE(consumer.base(), producer.base());
+
+    auto* seen_numbers = consumer.find<shm_vector<int>>("numbers");
+    auto* seen_items = consumer.find<shm_list<int>>("items");
+    auto* seen_queue = consumer.find<shm_deque<int>>("queue");
+    auto* seen_text = consumer.find<shm_string>("text");
+    ASSERT_TRUE(seen_numbers && seen_items && seen_queue && seen_text);
+    EXPECT_TRUE(consumer.contains(seen_numbers->data()));
+    EXPECT_TRUE(consumer.contains(seen_text->c_str()));
+
+    ASSERT_EQ(seen_numbers->size(), 1000u);
+    int expected = 0;
+    for (int value : *seen_numbers)
+        EXPECT_EQ(value, expected++);
+    expected = 0;
+    for (int value : *seen_items)
+        EXPECT_EQ(value, expected++);
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ((*seen_queue)[i], 999 - i);
+    EXPECT_STREQ(seen_text->c_str(), "a string long enough for the heap");
+
+    // Writes through either mapping land in the same memory.
+    seen_numbers->push_back(1000);
+    *seen_text += ", and then some";
+    EXPECT_EQ((*numbers)[1000], 1000);
+    EXPECT_STREQ(text->c_str(), "a string long enough for the heap, and then some");
+
+    producer.destroy<shm_vector<int>>("numbers");
+    producer.destroy<shm_list<int>>("items");
+    producer.destroy<shm_deque<int>>("queue");
+    producer.destroy<shm_string>("text");
+}
+
+TEST(SharedSegmentTest, AllocatesFromManyThreads) {
+    ScopedSegment scoped;
+    mtl::shared_segment& segment = scoped.segment;
+    size_t initial = segment.free_bytes();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&segment]
+        {
+            mtl::segment_allocator<int> alloc{ segment };
+            shm_vector<int> numbers{ alloc };
+            for (int i = 0; i < 10000; ++i)
+                numbers.push_back(i);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(segment.free_bytes(), initial);
+}
+
+#if !defined(_WIN32)
+TEST(SharedSegmentTest, ChildProcessReadsTheTable) {
+    ScopedSegment scoped;
+    mtl::segment_allocator<long> alloc{ scoped.segment };
+    auto* table = scoped.segment.construct<shm_vector<long>>("table", alloc);
+    for (long i = 0; i < 100000; ++i)
+        table->push_back(i * i);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        // Unmap the inherited view first so the child reads a fresh mapping.
+        std::string name = scoped.name;
+        scoped.segment = mtl::shared_segment(mtl::shared_segment::open, name);
+        auto* seen = scoped.segment.find<shm_vector<long>>("table");
+        bool ok = seen && seen->size() == 100000;
+        for (long i = 0; ok && i < 100000; ++i)
+            ok = (*seen)[i] == i * i;
+        _exit(ok ? 0 : 1);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    scoped.segment.destroy<shm_vector<long>>("table");
+}
+#endif
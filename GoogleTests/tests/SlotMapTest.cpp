@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+#include "MTL/Memory.hpp"
+#include "MTL/SlotMap.hpp"
+#include "MTL/String.hpp"
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+TEST(SlotMapTest, HandlesFindTheirValues) {
+    mtl::slot_map<mtl::string> names;
+    mtl::slot_handle alice = names.insert(mtl::string("alice"));
+    mtl::slot_handle bob = names.emplace("bob");
+
+    EXPECT_EQ(names.size(), 2u);
+    EXPECT_STREQ(names[alice].c_str(), "alice");
+    EXPECT_STREQ(names.at(bob).c_str(), "bob");
+    EXPECT_NE(alice, bob);
+    static_assert(sizeof(mtl::slot_handle) == sizeof(uint64_t));
+    EXPECT_EQ(mtl::slot_handle::from_bits(bob.to_bits()), bob);
+
+    EXPECT_FALSE(names.contains(mtl::slot_handle{}));
+    EXPECT_EQ(names.find(mtl::slot_handle{ 7, 1 }), nullptr);
+    EXPECT_THROW(names.at(mtl::slot_handle{}), std::out_of_range);
+}
+
+TEST(SlotMapTest, ErasedHandlesGoStale) {
+    mtl::slot_map<int> values;
+    mtl::slot_handle first = values.insert(1);
+    EXPECT_TRUE(values.erase(first));
+    EXPECT_FALSE(values.erase(first));
+    EXPECT_FALSE(values.contains(first));
+
+    // The freed slot is reused under a new generation.
+    mtl::slot_handle second = values.insert(2);
+    EXPECT_EQ(second.index, first.index);
+    EXPECT_NE(second.generation, first.generation);
+    EXPECT_EQ(values.find(first), nullptr);
+    EXPECT_EQ(values[second], 2);
+}
+
+TEST(SlotMapTest, EraseKeepsValuesDense) {
+    mtl::slot_map<int> values;
+    std::vector<mtl::slot_handle> handles;
+    for (int i = 0; i < 10; ++i)
+        handles.push_back(values.insert(i));
+
+    values.erase(handles[2]);
+    values.erase(handles[5]);
+    ASSERT_EQ(values.size(), 8u);
+
+    // The last values moved into the holes and their handles followed them.
+    EXPECT_EQ(values.data()[2], 9);
+    EXPECT_EQ(values.data()[5], 8);
+    for (int i = 0; i < 10; ++i)
+    {
+        if (i == 2 || i == 5)
+            continue;
+        ASSERT_TRUE(values.contains(handles[i]));
+        EXPECT_EQ(values[handles[i]], i);
+    }
+
+    for (size_t position = 0; position < values.size(); ++position)
+        EXPECT_EQ(values[values.handle_at(position)], values.data()[position]);
+
+    int sum = 0;
+    for (int value : values)
+        sum += value;
+    EXPECT_EQ(sum, 45 - 2 - 5);
+}
+
+TEST(SlotMapTest, ClearInvalidatesEveryHandle) {
+    mtl::slot_map<mtl::unique_ptr<int>> values;
+    mtl::slot_handle a = values.emplace(new int(1));
+    mtl::slot_handle b = values.emplace(new int(2));
+    values.clear();
+
+    EXPECT_TRUE(values.empty());
+    EXPECT_FALSE(values.contains(a));
+    EXPECT_FALSE(values.contains(b));
+
+    mtl::slot_handle c = values.emplace(new int(3));
+    EXPECT_EQ(*values[c], 3);
+    EXPECT_FALSE(values.contains(a));
+}
+
+TEST(SlotMapTest, CopiesAndMovesKeepHandlesValid) {
+    mtl::slot_map<int> original;
+    mtl::slot_handle kept = original.insert(1);
+    mtl::slot_handle erased = original.insert(2);
+    original.erase(erased);
+
+    mtl::slot_map<int> copy = original;
+    EXPECT_EQ(copy[kept], 1);
+    EXPECT_FALSE(copy.contains(erased));
+
+    mtl::slot_map<int> moved = std::move(original);
+    EXPECT_EQ(moved[kept], 1);
+    EXPECT_TRUE(original.empty());
+    mtl::slot_handle fresh = original.insert(3);
+    EXPECT_EQ(original[fresh], 3);
+}
+
+TEST(SlotMapTest, RandomOperationsMatchAReferenceModel) {
+    mtl::slot_map<int> values;
+    std::vector<std::pair<mtl::slot_handle, int>> live;
+    std::vector<mtl::slot_handle> dead;
+    std::mt19937 rng(42);
+
+    for (int step = 0; step < 20000; ++step)
+    {
+        if (live.empty() || rng() % 3 != 0)
+        {
+            int value = static_cast<int>(rng());
+            live.emplace_back(values.insert(value), value);
+        }
+        else
+        {
+            size_t victim = rng() % live.size();
+            ASSERT_TRUE(values.erase(live[victim].first));
+            dead.push_back(live[victim].first);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+
+    ASSERT_EQ(values.size(), live.size());
+    for (const auto& [key, value] : live)
+        EXPECT_EQ(values[key], value);
+    for (mtl::slot_handle key : dead)
+        EXPECT_FALSE(values.contains(key));
+}
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include "MTL/StackArena.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <cstdint>
+
+namespace
+{
+    template <typename T, size_t N>
+    using small_vector = mtl::vector<T, mtl::short_alloc<T, N>>;
+}
+
+TEST(StackArenaTest, ServesFromTheBufferUntilFull) {
+    mtl::stack_arena<256> arena;
+    void* first = arena.allocate(10);
+    void* second = arena.allocate(100);
+
+    EXPECT_TRUE(arena.owns(first));
+    EXPECT_TRUE(arena.owns(second));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t), 0u);
+    EXPECT_EQ(arena.used(), 16u + 112u);
+
+    void* overflow = arena.allocate(200);
+    EXPECT_FALSE(arena.owns(overflow));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(overflow) % alignof(std::max_align_t), 0u);
+    arena.deallocate(overflow, 200);
+}
+
+TEST(StackArenaTest, HugeRequestsDoNotWrapIntoTheBuffer) {
+    mtl::stack_arena<256> arena;
+    EXPECT_THROW(arena.allocate(SIZE_MAX), std::bad_alloc);
+    EXPECT_THROW(arena.allocate(SIZE_MAX - 1), std::bad_alloc);
+    EXPECT_EQ(arena.used(), 0u);
+}
+
+TEST(StackArenaTest, OnlyTheLastAllocationIsReclaimed) {
+    mtl::stack_arena<256> arena;
+    void* first = arena.allocate(32);
+    void* second = arena.allocate(32);
+
+    arena.deallocate(first, 32);
+    EXPECT_EQ(arena.used(), 64u);
+    arena.deallocate(second, 32);
+    EXPECT_EQ(arena.used(), 32u);
+    EXPECT_EQ(arena.allocate(48), second);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+}
+
+TEST(StackArenaTest, VectorGrowsInsideTheBuffer) {
+    mtl::stack_arena<2048> arena;
+    small_vector<int, 2048> numbers{ arena };
+    for (int i = 0; i < 64; ++i)
+        numbers.push_back(i);
+
+    EXPECT_TRUE(arena.owns(numbers.data()));
+    for (int i = 0; i < 64; ++i)
+        EXPECT_EQ(numbers[i], i);
+
+    // Each buffer the vector outgrew is stranded below the live one.
+    EXPECT_GT(arena.used(), numbers.capacity() * sizeof(int));
+
+    // A reserved vector is the newest block, so its buffer is rewound.
+    size_t used = arena.used();
+    {
+        small_vector<int, 2048> scratch{ arena };
+        scratch.reserve(100);
+        EXPECT_TRUE(arena.owns(scratch.data()));
+    }
+    EXPECT_EQ(arena.used(), used);
+}
+
+TEST(StackArenaTest, VectorOverflowsToTheHeap) {
+    mtl::stack_arena<128> arena;
+    small_vector<int, 128> numbers{ arena };
+    for (int i = 0; i < 1000; ++i)
+        numbers.push_back(i);
+
+    EXPECT_FALSE(arena.owns(numbers.data()));
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_EQ(numbers[i], i);
+
+    numbers.clear();
+    small_vector<int, 128> copy{ numbers };
+    EXPECT_EQ(&copy.get_allocator().arena(), &arena);
+}
+
+TEST(StackArenaTest, BacksNodeAndStringContainers) {
+    mtl::stack_arena<4096> arena;
+    mtl::list<int, mtl::short_alloc<int, 4096>> items{ arena };
+    for (int i = 0; i < 20; ++i)
+        items.push_back(i);
+    EXPECT_EQ(items.size(), 20u);
+    EXPECT_EQ(items.back(), 19);
+
+    mtl::basic_string<mtl::short_alloc<char, 4096>> text{ "a string too long for the small string buffer", arena };
+    text += " and then some";
+    EXPECT_STREQ(text.c_str(), "a string too long for the small string buffer and then some");
+    EXPECT_GT(arena.used(), 0u);
+}
+
+TEST(StackArenaTest, AllocatorsCompareByArena) {
+    mtl::stack_arena<64> first;
+    mtl::stack_arena<64> second;
+    mtl::short_alloc<int, 64> a{ first };
+    mtl::short_alloc<double, 64> b{ a };
+
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a == (mtl::short_alloc<int, 64>{ second }));
+}
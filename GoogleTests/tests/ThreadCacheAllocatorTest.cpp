@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "MTL/ThreadCacheAllocator.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using heap = mtl::detail::thread_cache_heap;
+
+    struct alignas(64) CacheLine
+    {
+        int value{ 0 };
+    };
+}
+
+TEST(ThreadCacheAllocatorTest, SizeClassesCoverEverySmallSize) {
+    for (size_t bytes = 1; bytes <= heap::MAX_SMALL; ++bytes)
+    {
+        size_t cls = heap::class_index(bytes);
+        ASSERT_LT(cls, heap::CLASS_COUNT);
+        ASSERT_GE(heap::class_size(cls), bytes);
+        if (cls > 0)
+        {
+            ASSERT_LT(heap::class_size(cls - 1), bytes);
+        }
+    }
+    // Four classes per power of two keep internal waste under 25%.
+    for (size_t cls = 8; cls < heap::CLASS_COUNT; ++cls)
+        EXPECT_LE(heap::class_size(cls) - heap::class_size(cls - 1), heap::class_size(cls - 1) / 4);
+}
+
+TEST(ThreadCacheAllocatorTest, FreedBlocksAreReused) {
+    mtl::thread_cache_allocator<std::byte> alloc;
+    std::byte* first = alloc.allocate(100);
+    alloc.deallocate(first, 100);
+    EXPECT_EQ(alloc.allocate(112), first);
+    alloc.deallocate(first, 112);
+
+    std::byte* large = alloc.allocate(100 * 1024);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % heap::PAGE_SIZE, 0u);
+    alloc.deallocate(large, 100 * 1024);
+    EXPECT_EQ(alloc.allocate(100 * 1024), large);
+    alloc.deallocate(large, 100 * 1024);
+
+    std::byte* huge = alloc.allocate(4 * 1024 * 1024);
+    huge[4 * 1024 * 1024 - 1] = std::byte{ 1 };
+    alloc.deallocate(huge, 4 * 1024 * 1024);
+}
+
+TEST(ThreadCacheAllocatorTest, AlignmentIsHonoured) {
+    mtl::thread_cache_allocator<long double> small;
+    for (int i = 0; i < 100; ++i)
+    {
+        long double* ptr = small.allocate(1);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % heap::MIN_ALIGN, 0u);
+        small.deallocate(ptr, 1);
+    }
+
+    mtl::thread_cache_allocator<CacheLine> wide;
+    CacheLine* line = wide.allocate(3);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(line) % 64, 0u);
+    wide.deallocate(line, 3);
+}
+
+TEST(ThreadCacheAllocatorTest, PlugsIntoContainers) {
+    mtl::vector<int, mtl::thread_cache_allocator<int>> values;
+    mtl::list<int, mtl::thread_cache_allocator<int>> items;
+    mtl::deque<int, mtl::thread_cache_allocator<int>> queue;
+    mtl::basic_string<mtl::thread_cache_allocator<char>> text;
+    for (int i = 0; i < 1000; ++i)
+    {
+        values.push_back(i);
+        items.push_back(i);
+        queue.push_front(i);
+        text += "x";
+    }
+    EXPECT_EQ(values[999], 999);
+    EXPECT_EQ(items.back(), 999);
+    EXPECT_EQ(queue[0], 999);
+    EXPECT_EQ(text.size(), 1000u);
+
+    auto copy = items;
+    auto moved = std::move(copy);
+    EXPECT_EQ(moved.size(), 1000u);
+}
+
+TEST(ThreadCacheAllocatorTest, BatchesMoveBetweenThreads) {
+    constexpr size_t COUNT = 10'000;
+    mtl::thread_cache_allocator<std::byte> alloc;
+    std::vector<std::byte*> blocks;
+    std::thread([&] {
+        for (size_t i = 0; i < COUNT; ++i)
+            blocks.push_back(alloc.allocate(48));
+    }).join();
+
+    mtl::thread_cache_stats before = mtl::thread_cache_allocator_stats();
+    for (std::byte* block : blocks)
+        alloc.deallocate(block, 48);
+    mtl::thread_cache_stats after = mtl::thread_cache_allocator_stats();
+    EXPECT_GT(after.batches_released, before.batches_released);
+
+    // Blocks freed here are fetched back by another thread without new spans.
+    std::thread([&] {
+        for (size_t i = 0; i < COUNT; ++i)
+            blocks[i] = alloc.allocate(48);
+        for (std::byte* block : blocks)
+            alloc.deallocate(block, 48);
+    }).join();
+    mtl::thread_cache_stats reused = mtl::thread_cache_allocator_stats();
+    EXPECT_EQ(reused.spans_carved, after.spans_carved);
+    EXPECT_GT(reused.batches_fetched, after.batches_fetched);
+}
+
+TEST(ThreadCacheAllocatorTest, ConcurrentChurn) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t] {
+            mtl::thread_cache_allocator<std::byte> alloc;
+            std::vector<std::pair<std::byte*, size_t>> live;
+            for (size_t i = 0; i < 20'000; ++i)
+            {
+                size_t bytes = 1 + (i * 7919 + t * 104729) % 2048;
+                std::byte* ptr = alloc.allocate(bytes);
+                ptr[0] = ptr[bytes - 1] = std::byte{ 0x5a };
+                live.emplace_back(ptr, bytes);
+                if (live.size() > 64)
+                {
+                    alloc.deallocate(live.front().first, live.front().second);
+                    live.erase(live.begin());
+                }
+            }
+            for (auto [ptr, bytes] : live)
+                alloc.deallocate(ptr, bytes);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
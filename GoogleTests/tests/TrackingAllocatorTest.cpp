@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+#include "MTL/TrackingAllocator.hpp"
+#include "MTL/Deque.hpp"
+#include "MTL/List.hpp"
+#include "MTL/String.hpp"
+#include "MTL/Vector.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct VectorTag { static constexpr const char* name = "test.vector"; };
+    struct DequeTag { static constexpr const char* name = "test.deque"; };
+    struct ListTag { static constexpr const char* name = "test.list"; };
+    struct StringTag { static constexpr const char* name = "test.string"; };
+    struct ThreadTag { static constexpr const char* name = "test.threads"; };
+
+    template <typename T, typename Tag>
+    using tracked = mtl::tracking_allocator<T, Tag>;
+}
+
+TEST(TrackingAllocatorTest, HistogramBucketsArePowersOfTwo) {
+    EXPECT_EQ(mtl::allocation_stats::bucket(0), 0u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(1), 0u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(2), 1u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(3), 2u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(4), 2u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(4096), 12u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(4097), 13u);
+    EXPECT_EQ(mtl::allocation_stats::bucket(SIZE_MAX), mtl::allocation_stats::HISTOGRAM_BUCKETS - 1);
+}
+
+TEST(TrackingAllocatorTest, VectorGrowthStaysWithinBudget) {
+    mtl::allocation_scope scope{ VectorTag::name };
+    {
+        mtl::vector<int, tracked<int, VectorTag>> numbers;
+        for (int i = 0; i < 100; ++i)
+            numbers.push_back(i);
+
+        // Capacities 1, 2, 3, 4, 6, 9, 13, 19, 28, 42, 63, 94, 141.
+        mtl::allocation_stats stats = scope.stats();
+        EXPECT_EQ(stats.allocations, 13u);
+        EXPECT_EQ(stats.deallocations, 12u);
+        EXPECT_EQ(stats.bytes_allocated, 425 * sizeof(int));
+        EXPECT_EQ(stats.live_bytes, 141 * sizeof(int));
+        // The old and new buffers overlap during the last reallocation.
+        EXPECT_EQ(stats.peak_bytes, (94 + 141) * sizeof(int));
+    }
+    mtl::allocation_stats stats = scope.stats();
+    EXPECT_EQ(stats.deallocations, 13u);
+    EXPECT_EQ(stats.live_bytes, 0u);
+    EXPECT_EQ(stats.bytes_deallocated, stats.bytes_allocated);
+}
+
+TEST(TrackingAllocatorTest, TracksRebindingContainers) {
+    mtl::allocation_scope deque_scope{ DequeTag::name };
+    mtl::allocation_scope list_scope{ ListTag::name };
+    {
+        mtl::deque<int, tracked<int, DequeTag>> queue;
+        mtl::list<int, tracked<int, ListTag>> items;
+        for (int i = 0; i < 1000; ++i)
+        {
+            queue.push_front(i);
+            items.push_back(i);
+        }
+        EXPECT_GT(deque_scope.stats().live_bytes, 1000 * sizeof(int));
+        EXPECT_EQ(list_scope.stats().allocations, 1000u);
+    }
+
+    // Blocks and the map both report to the deque's tag.
+    mtl::allocation_stats stats = deque_scope.stats();
+    EXPECT_GT(stats.allocations, 2u);
+    EXPECT_EQ(stats.allocations, stats.deallocations);
+    EXPECT_EQ(stats.live_bytes, 0u);
+    EXPECT_EQ(list_scope.stats().live_bytes, 0u);
+}
+
+TEST(TrackingAllocatorTest, SmallStringsDoNotAllocate) {
+    mtl::allocation_scope scope{ StringTag::name };
+    {
+        mtl::basic_string<tracked<char, StringTag>> text("short");
+        EXPECT_EQ(scope.stats().allocations, 0u);
+
+        text += " but now long enough to need the heap";
+        EXPECT_EQ(scope.stats().allocations, 1u);
+    }
+    EXPECT_EQ(scope.stats().live_bytes, 0u);
+}
+
+TEST(TrackingAllocatorTest, RegistryReportsEveryTag) {
+    {
+        mtl::vector<int, tracked<int, VectorTag>> numbers;
+        numbers.push_back(1);
+    }
+
+    mtl::allocation_registry& registry = mtl::global_allocation_registry();
+    EXPECT_GT(registry.snapshot(VectorTag::name).allocations, 0u);
+    EXPECT_EQ(registry.snapshot("no such tag").allocations, 0u);
+
+    bool found = false;
+    registry.for_each([&](std::string_view tag, const mtl::allocation_stats& stats)
+    {
+        if (tag == VectorTag::name)
+        {
+            found = true;
+            EXPECT_EQ(stats.live_bytes, 0u);
+        }
+    });
+    EXPECT_TRUE(found);
+    EXPECT_GE(registry.total().allocations, registry.snapshot(VectorTag::name).allocations);
+
+    registry.reset(VectorTag::name);
+    EXPECT_EQ(registry.snapshot(VectorTag::name).allocations, 0u);
+    EXPECT_EQ((tracked<int, VectorTag>::stats().allocations), 0u);
+}
+
+TEST(TrackingAllocatorTest, ResetDuringAScopeDoesNotWrap) {
+    mtl::vector<int, tracked<int, VectorTag>> numbers;
+    mtl::allocation_scope scope{ VectorTag::name };
+    numbers.push_back(1);
+    numbers.push_back(2);
+
+    mtl::global_allocation_registry().reset(VectorTag::name);
+    mtl::allocation_stats stats = scope.stats();
+    EXPECT_EQ(stats.allocations, 0u);
+    EXPECT_EQ(stats.bytes_allocated, 0u);
+    for (size_t count : stats.histogram)
+        EXPECT_EQ(count, 0u);
+}
+
+TEST(TrackingAllocatorTest, CountsConcurrentAllocations) {
+    constexpr size_t THREADS = 4;
+    constexpr size_t PER_THREAD = 10000;
+    mtl::allocation_scope scope{ ThreadTag::name };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([]
+        {
+            tracked<double, ThreadTag> alloc;
+            for (size_t i = 0; i < PER_THREAD; ++i)
+                alloc.deallocate(alloc.allocate(4), 4);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    mtl::allocation_stats stats = scope.stats();
+    EXPECT_EQ(stats.allocations, THREADS * PER_THREAD);
+    EXPECT_EQ(stats.histogram[mtl::allocation_stats::bucket(4 * sizeof(double))], THREADS * PER_THREAD);
+    EXPECT_EQ(stats.live_bytes, 0u);
+    EXPECT_LE(stats.peak_bytes, THREADS * 4 * sizeof(double));
+}
+
+TEST(TrackingAllocatorTest, ForwardsToTheUpstreamAllocator) {
+    tracked<int, VectorTag> a;
+    tracked<long, VectorTag> b{ a };
+    EXPECT_TRUE(a == b);
+
+    mtl::vector<int, tracked<int, VectorTag>> numbers;
+    numbers.push_back(1);
+    mtl::vector<int, tracked<int, VectorTag>> copy{ numbers };
+    EXPECT_EQ(copy[0], 1);
+    static_assert(std::is_same_v<std::allocator_traits<tracked<int, VectorTag>>::rebind_alloc<long>::upstream_type, std::allocator<long>>);
+}
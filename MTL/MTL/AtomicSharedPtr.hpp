@@ -0,0 +1,181 @@
+#pragma once
+#include "Memory.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+namespace mtl
+{
+	// Lock-free slot holding a shared_ptr<T>.
+	//
+	// The slot owns a heap node that carries the current value. Its address
+	// shares one 64-bit word with an "external" count of readers that are
+	// copying out of the node right now: load() bumps the count and the
+	// pointer in a single fetch_add, copies the value and then gives the
+	// borrow back. If a writer swapped the node out in the meantime, the
+	// writer moves the outstanding external count into the node's internal
+	// count and the last of those readers frees it.
+	//
+	// On 64-bit targets the count lives in the top 16 bits, so node addresses
+	// must fit in 48 bits. That rules out 5-level paging with high mappings
+	// and pointer tags such as ARM top-byte-ignore or MTE; debug builds
+	// assert it on every store.
+	template <typename T>
+	class atomic_shared_ptr
+	{
+		struct node
+		{
+			explicit node(shared_ptr<T>&& value)
+				: value(std::move(value))
+			{
+			}
+
+			shared_ptr<T> value;
+			std::atomic<std::ptrdiff_t> borrowers{ 0 };
+		};
+
+		static constexpr unsigned COUNT_SHIFT{ sizeof(void*) == 8 ? 48 : 32 };
+		static constexpr std::uint64_t COUNT_ONE{ std::uint64_t(1) << COUNT_SHIFT };
+		static constexpr std::uint64_t POINTER_MASK{ COUNT_ONE - 1 };
+
+	public:
+		atomic_shared_ptr() noexcept = default;
+		atomic_shared_ptr(shared_ptr<T> desired)
+			: m_Word(to_word(make_node(std::move(desired))))
+		{
+		}
+		~atomic_shared_ptr()
+		{
+			delete to_node(m_Word.load(std::memory_order_acquire));
+		}
+		atomic_shared_ptr(const atomic_shared_ptr&) = delete;
+		atomic_shared_ptr& operator=(const atomic_shared_ptr&) = delete;
+		atomic_shared_ptr& operator=(shared_ptr<T> desired)
+		{
+			store(std::move(desired));
+			return *this;
+		}
+		operator shared_ptr<T>() const
+		{
+			return load();
+		}
+
+		bool is_lock_free() const noexcept
+		{
+			return m_Word.is_lock_free();
+		}
+		shared_ptr<T> load() const
+		{
+			node* current = borrow();
+			shared_ptr<T> result;
+			if (current)
+				result = current->value;
+
+			return_borrow(current);
+			return result;
+		}
+		void store(shared_ptr<T> desired)
+		{
+			exchange(std::move(desired));
+		}
+		shared_ptr<T> exchange(shared_ptr<T> desired)
+		{
+			std::uint64_t old = m_Word.exchange(to_word(make_node(std::move(desired))), std::memory_order_acq_rel);
+			node* previous = to_node(old);
+			if (!previous)
+				return shared_ptr<T>();
+
+			// Nobody can free the node before retire() hands over the count.
+			shared_ptr<T> result = previous->value;
+			retire(previous, count(old));
+			return result;
+		}
+		bool compare_exchange_strong(shared_ptr<T>& expected, shared_ptr<T> desired)
+		{
+			std::uint64_t word = m_Word.fetch_add(COUNT_ONE, std::memory_order_acquire) + COUNT_ONE;
+			node* current = to_node(word);
+			node* replacement = nullptr;
+			while (true)
+			{
+				if (!equivalent(current, expected))
+				{
+					expected = current ? current->value : shared_ptr<T>();
+					return_borrow(current);
+					delete replacement;
+					return false;
+				}
+				if (!replacement)
+					replacement = make_node(std::move(desired));
+
+				if (m_Word.compare_exchange_weak(word, to_word(replacement), std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					retire(current, count(word) - 1);
+					return true;
+				}
+				if (to_node(word) != current)
+				{
+					return_borrow(current);
+					word = m_Word.fetch_add(COUNT_ONE, std::memory_order_acquire) + COUNT_ONE;
+					current = to_node(word);
+				}
+			}
+		}
+		bool compare_exchange_weak(shared_ptr<T>& expected, shared_ptr<T> desired)
+		{
+			return compare_exchange_strong(expected, std::move(desired));
+		}
+
+	private:
+		static node* make_node(shared_ptr<T>&& value)
+		{
+			if (!value && value.use_count() == 0)
+				return nullptr;
+
+			return new node(std::move(value));
+		}
+		static node* to_node(std::uint64_t word) noexcept
+		{
+			return reinterpret_cast<node*>(static_cast<std::uintptr_t>(word & POINTER_MASK));
+		}
+		static std::uint64_t to_word(node* ptr) noexcept
+		{
+			assert((static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr)) >> COUNT_SHIFT) == 0 && "node address overlaps the borrow count");
+			return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr));
+		}
+		static std::ptrdiff_t count(std::uint64_t word) noexcept
+		{
+			return static_cast<std::ptrdiff_t>(word >> COUNT_SHIFT);
+		}
+		static bool equivalent(node* current, const shared_ptr<T>& expected) noexcept
+		{
+			if (!current)
+				return !expected && expected.use_count() == 0;
+
+			const shared_ptr<T>& value = current->value;
+			return value.get() == expected.get() && !value.owner_before(expected) && !expected.owner_before(value);
+		}
+		node* borrow() const noexcept
+		{
+			return to_node(m_Word.fetch_add(COUNT_ONE, std::memory_order_acquire));
+		}
+		void return_borrow(node* borrowed) const noexcept
+		{
+			std::uint64_t word = m_Word.load(std::memory_order_relaxed);
+			while (to_node(word) == borrowed)
+			{
+				if (m_Word.compare_exchange_weak(word, word - COUNT_ONE, std::memory_order_release, std::memory_order_relaxed))
+					return;
+			}
+			if (borrowed && borrowed->borrowers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				delete borrowed;
+		}
+		static void retire(node* previous, std::ptrdiff_t borrowers) noexcept
+		{
+			if (previous && previous->borrowers.fetch_add(borrowers, std::memory_order_acq_rel) + borrowers == 0)
+				delete previous;
+		}
+
+	private:
+		mutable std::atomic<std::uint64_t> m_Word{ 0 };
+	};
+}
@@ -0,0 +1,242 @@
+#pragma once
+#include "Memory.hpp"
+#include "Vector.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace mtl
+{
+	// Biased reference counting policy for shared_ptr.
+	//
+	// The thread that creates a control block owns its counts: it updates a
+	// private biased counter with plain loads and stores. Every other thread
+	// uses an atomic shared counter that may go negative while the owner
+	// still holds the balance. Once the owner's biased counter drops to zero
+	// it merges it into the shared counter; from then on every thread uses
+	// the shared counter alone. A non-owner that drives the shared counter
+	// negative queues the count on its owner thread. That thread merges every
+	// count queued on it when one of its owner-path decrements leaves a
+	// nonzero biased count, when it calls merge_pending(), and when it exits.
+	// Owner increments do not merge, so a thread that only ever increments
+	// should call merge_pending() to release objects others let go of.
+	//
+	//   mtl::shared_ptr<T, mtl::biased_ref_count> ptr = mtl::make_shared<T, mtl::biased_ref_count>();
+	class biased_ref_count
+	{
+		struct owner_record
+		{
+			std::mutex mutex;
+			mtl::vector<biased_ref_count*> queue;
+			std::atomic<bool> pending{ false };
+			std::atomic<bool> closed{ false };
+			std::atomic<size_t> refs{ 1 };
+
+			void retain() noexcept
+			{
+				refs.fetch_add(1, std::memory_order_relaxed);
+			}
+			void release() noexcept
+			{
+				if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					delete this;
+			}
+		};
+
+		struct thread_owner
+		{
+			thread_owner()
+			{
+				t_Current = record;
+			}
+			~thread_owner()
+			{
+				mtl::vector<biased_ref_count*> batch;
+				{
+					std::lock_guard lock(record->mutex);
+					record->closed.store(true, std::memory_order_relaxed);
+					swap(batch, record->queue);
+				}
+				settle_all(batch);
+				// Later owner_path() or merge_pending() calls on this thread,
+				// say from another thread_local's destructor, must not see
+				// the record once it may be freed.
+				t_Current = nullptr;
+				record->release();
+			}
+
+			owner_record* record{ new owner_record() };
+		};
+
+		static constexpr std::int64_t MERGED{ 1 };
+		static constexpr std::int64_t QUEUED{ 2 };
+		static constexpr std::int64_t UNIT{ 4 };
+
+	public:
+		explicit biased_ref_count(size_t count) noexcept
+			: m_Biased(count), m_Owner(current_owner())
+		{
+			m_Owner->retain();
+		}
+		~biased_ref_count()
+		{
+			m_Owner->release();
+		}
+		biased_ref_count(const biased_ref_count&) = delete;
+		biased_ref_count& operator=(const biased_ref_count&) = delete;
+
+		void bind(void* context, void (*on_zero)(void*)) noexcept
+		{
+			m_Context = context;
+			m_OnZero = on_zero;
+		}
+		void increment() noexcept
+		{
+			if (owner_path())
+				m_Biased.store(m_Biased.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			else
+				m_Shared.fetch_add(UNIT, std::memory_order_relaxed);
+		}
+		bool try_increment() noexcept
+		{
+			if (owner_path())
+			{
+				increment();
+				return true;
+			}
+			std::int64_t old = m_Shared.load(std::memory_order_relaxed);
+			while (!dead(old))
+			{
+				if (m_Shared.compare_exchange_weak(old, old + UNIT, std::memory_order_acq_rel, std::memory_order_relaxed))
+					return true;
+			}
+			return false;
+		}
+		bool decrement() noexcept
+		{
+			if (owner_path())
+			{
+				size_t biased = m_Biased.load(std::memory_order_relaxed) - 1;
+				m_Biased.store(biased, std::memory_order_relaxed);
+				if (biased != 0)
+				{
+					merge_pending(m_Owner);
+					return false;
+				}
+				return dead(merge(0));
+			}
+			return decrement_shared();
+		}
+		size_t load() const noexcept
+		{
+			std::int64_t shared = m_Shared.load(std::memory_order_relaxed);
+			std::int64_t total = count(shared) + static_cast<std::int64_t>(m_Biased.load(std::memory_order_relaxed));
+			return total > 0 ? static_cast<size_t>(total) : 0;
+		}
+
+		// Merges the counts other threads queued on the calling thread.
+		static void merge_pending()
+		{
+			if (t_Current)
+				merge_pending(t_Current);
+		}
+
+	private:
+		static owner_record* current_owner()
+		{
+			thread_local thread_owner owner;
+			return owner.record;
+		}
+		static std::int64_t count(std::int64_t shared) noexcept
+		{
+			return shared >> 2;
+		}
+		static bool dead(std::int64_t shared) noexcept
+		{
+			return (shared & MERGED) && !(shared & QUEUED) && count(shared) == 0;
+		}
+		static void merge_pending(owner_record* record)
+		{
+			if (!record->pending.load(std::memory_order_acquire))
+				return;
+
+			mtl::vector<biased_ref_count*> batch;
+			{
+				std::lock_guard lock(record->mutex);
+				swap(batch, record->queue);
+				record->pending.store(false, std::memory_order_relaxed);
+			}
+			settle_all(batch);
+		}
+		static void settle_all(mtl::vector<biased_ref_count*>& batch)
+		{
+			for (biased_ref_count* counter : batch)
+			{
+				if (dead(counter->merge(QUEUED)))
+					counter->m_OnZero(counter->m_Context);
+			}
+		}
+
+		bool owner_path() const noexcept
+		{
+			return m_Owner == t_Current
+				&& !m_Owner->closed.load(std::memory_order_relaxed)
+				&& !(m_Shared.load(std::memory_order_relaxed) & MERGED);
+		}
+		// Folds the biased count into the shared one and clears `flags`. Only
+		// the owner, or a non-owner holding the mutex of a closed owner, may
+		// call this.
+		std::int64_t merge(std::int64_t flags) noexcept
+		{
+			std::int64_t delta = -flags;
+			if (!(m_Shared.load(std::memory_order_relaxed) & MERGED))
+			{
+				delta += static_cast<std::int64_t>(m_Biased.exchange(0, std::memory_order_relaxed)) * UNIT + MERGED;
+			}
+			return m_Shared.fetch_add(delta, std::memory_order_acq_rel) + delta;
+		}
+		bool decrement_shared() noexcept
+		{
+			std::int64_t old = m_Shared.load(std::memory_order_relaxed);
+			while (true)
+			{
+				std::int64_t next = old - UNIT;
+				bool enqueue = !(old & (MERGED | QUEUED)) && count(next) < 0;
+				if (enqueue)
+					next |= QUEUED;
+
+				if (m_Shared.compare_exchange_weak(old, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					if (enqueue)
+						queue_on_owner();
+					return dead(next);
+				}
+			}
+		}
+		void queue_on_owner()
+		{
+			bool zero = false;
+			{
+				std::lock_guard lock(m_Owner->mutex);
+				if (!m_Owner->closed.load(std::memory_order_relaxed))
+				{
+					m_Owner->queue.push_back(this);
+					m_Owner->pending.store(true, std::memory_order_release);
+					return;
+				}
+				zero = dead(merge(QUEUED));
+			}
+			if (zero)
+				m_OnZero(m_Context);
+		}
+
+	private:
+		inline static thread_local owner_record* t_Current{ nullptr };
+
+		std::atomic<size_t> m_Biased;
+		std::atomic<std::int64_t> m_Shared{ 0 };
+		owner_record* m_Owner;
+		void* m_Context{ nullptr };
+		void (*m_OnZero)(void*){ nullptr };
+	};
+}
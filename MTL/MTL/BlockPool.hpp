@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include "ThreadLocalCache.hpp"
+
+namespace mtl
+{
+	struct block_pool_stats
+	{
+		size_t slab_allocations;
+		size_t bytes_reserved;
+		size_t batches_returned;
+		size_t batches_reused;
+	};
+
+	namespace detail
+	{
+		struct block_pool_counters
+		{
+			std::atomic<size_t> slab_allocations{ 0 };
+			std::atomic<size_t> bytes_reserved{ 0 };
+			std::atomic<size_t> batches_returned{ 0 };
+			std::atomic<size_t> batches_reused{ 0 };
+		};
+
+		inline block_pool_counters& control_block_pool_counters() noexcept
+		{
+			static block_pool_counters counters;
+			return counters;
+		}
+
+		// Fixed-size block allocator. Each thread allocates from and frees into
+		// its own free list without synchronization; blocks move between
+		// threads in batches through a mutex-guarded global list, and new
+		// memory is taken from the heap one slab at a time.
+		template <size_t Size, size_t Align>
+		class block_pool
+		{
+			struct free_node
+			{
+				free_node* next;
+				free_node* next_batch;
+				size_t batch_size;
+			};
+
+			static constexpr size_t ALIGNMENT{ Align > alignof(free_node) ? Align : alignof(free_node) };
+			static constexpr size_t BLOCK_SIZE{ ((Size > sizeof(free_node) ? Size : sizeof(free_node)) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT };
+			static constexpr size_t BATCH_SIZE{ 64 };
+			static constexpr size_t SLAB_BLOCKS{ 4 * BATCH_SIZE };
+
+			struct global_list
+			{
+				std::mutex mutex;
+				free_node* batches{ nullptr };
+				free_node* slabs{ nullptr };
+			};
+
+			struct thread_cache
+			{
+				free_node* head{ nullptr };
+				size_t count{ 0 };
+			};
+
+		public:
+			static void* allocate()
+			{
+				thread_cache& cache = local_cache::get();
+				if (!cache.head)
+					refill(cache);
+
+				free_node* node = cache.head;
+				cache.head = node->next;
+				--cache.count;
+				return node;
+			}
+			static void deallocate(void* ptr) noexcept
+			{
+				thread_cache& cache = local_cache::get();
+				auto node = static_cast<free_node*>(ptr);
+				node->next = cache.head;
+				cache.head = node;
+				if (++cache.count >= 2 * BATCH_SIZE || local_cache::flushed())
+					release_batch(cache);
+			}
+
+		private:
+			static global_list& global() noexcept
+			{
+				// Never destroyed: blocks may be freed by static destructors.
+				static global_list* list = new global_list();
+				return *list;
+			}
+			static void refill(thread_cache& cache)
+			{
+				global_list& list = global();
+				{
+					std::lock_guard lock(list.mutex);
+					if (free_node* batch = list.batches)
+					{
+						list.batches = batch->next_batch;
+						cache.head = batch;
+						cache.count = batch->batch_size;
+						control_block_pool_counters().batches_reused.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+				}
+
+				auto slab = static_cast<std::byte*>(::operator new(SLAB_BLOCKS * BLOCK_SIZE + BLOCK_SIZE, std::align_val_t(ALIGNMENT)));
+				auto& counters = control_block_pool_counters();
+				counters.slab_allocations.fetch_add(1, std::memory_order_relaxed);
+				counters.bytes_reserved.fetch_add(SLAB_BLOCKS * BLOCK_SIZE + BLOCK_SIZE, std::memory_order_relaxed);
+
+				// The first block records the slab so it stays reachable.
+				auto slab_node = reinterpret_cast<free_node*>(slab);
+				{
+					std::lock_guard lock(list.mutex);
+					slab_node->next = list.slabs;
+					list.slabs = slab_node;
+				}
+				for (size_t i = SLAB_BLOCKS; i > 0; --i)
+				{
+					auto node = reinterpret_cast<free_node*>(slab + i * BLOCK_SIZE);
+					node->next = cache.head;
+					cache.head = node;
+				}
+				cache.count += SLAB_BLOCKS;
+			}
+			// Hands up to BATCH_SIZE blocks from the front of the cache to the
+			// global list.
+			static void release_batch(thread_cache& cache) noexcept
+			{
+				free_node* batch = cache.head;
+				free_node* last = batch;
+				size_t taken = 1;
+				for (; taken < BATCH_SIZE && last->next; ++taken)
+					last = last->next;
+
+				cache.head = last->next;
+				cache.count -= taken;
+				last->next = nullptr;
+
+				batch->batch_size = taken;
+
+				global_list& list = global();
+				std::lock_guard lock(list.mutex);
+				batch->next_batch = list.batches;
+				list.batches = batch;
+				control_block_pool_counters().batches_returned.fetch_add(1, std::memory_order_relaxed);
+			}
+			static void flush(thread_cache& cache) noexcept
+			{
+				while (cache.head)
+					release_batch(cache);
+			}
+
+			using local_cache = thread_local_cache<thread_cache, &flush>;
+		};
+	}
+
+	// Counters for the pool behind shared_ptr's adopting constructor. Once a
+	// workload reaches steady state slab_allocations stops growing.
+	inline block_pool_stats control_block_pool_stats() noexcept
+	{
+		auto& counters = detail::control_block_pool_counters();
+		return {
+			counters.slab_allocations.load(std::memory_order_relaxed),
+			counters.bytes_reserved.load(std::memory_order_relaxed),
+			counters.batches_returned.load(std::memory_order_relaxed),
+			counters.batches_reused.load(std::memory_order_relaxed)
+		};
+	}
+}
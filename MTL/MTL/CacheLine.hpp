@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace mtl
+{
+	// Distance that keeps two objects from sharing a cache line, detected
+	// from the target architecture. Not std::hardware_destructive_interference_size:
+	// that one varies with compiler flags, which makes it unsafe in headers.
+	// x86-64 uses 128 because the adjacent-line prefetcher pulls cache lines
+	// in pairs; recent ARM64 cores also use 128-byte lines.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64) || defined(__powerpc64__)
+	inline constexpr size_t hardware_destructive_interference_size{ 128 };
+#elif defined(__arm__) || defined(_M_ARM) || defined(__mips__) || (defined(__riscv) && __riscv_xlen == 32)
+	inline constexpr size_t hardware_destructive_interference_size{ 32 };
+#elif defined(__s390x__)
+	inline constexpr size_t hardware_destructive_interference_size{ 256 };
+#else
+	inline constexpr size_t hardware_destructive_interference_size{ 64 };
+#endif
+	// Largest span guaranteed to share one cache line. Lines are at least
+	// 64 bytes where the destructive size is larger, so only targets with
+	// 32-byte lines go below 64.
+	inline constexpr size_t hardware_constructive_interference_size{ std::min<size_t>(64, hardware_destructive_interference_size) };
+
+	// Gives T a cache line (or pair of lines) of its own, so neighbouring
+	// elements written by different threads do not invalidate each other.
+	template <typename T>
+	struct alignas(hardware_destructive_interference_size) cache_padded
+	{
+		T value;
+
+		cache_padded() = default;
+		template <typename... Args>
+		explicit cache_padded(std::in_place_t, Args&&... args)
+			: value(std::forward<Args>(args)...)
+		{
+		}
+		cache_padded(const T& initial)
+			: value(initial)
+		{
+		}
+
+		T& operator*() noexcept
+		{
+			return value;
+		}
+		const T& operator*() const noexcept
+		{
+			return value;
+		}
+		T* operator->() noexcept
+		{
+			return &value;
+		}
+		const T* operator->() const noexcept
+		{
+			return &value;
+		}
+	};
+
+	// Allocator that aligns every allocation to at least Align bytes, so a
+	// container's buffer starts on a cache line boundary.
+	template <typename T, size_t Align = hardware_destructive_interference_size>
+	class aligned_allocator
+	{
+		static_assert(Align > 0 && (Align & (Align - 1)) == 0, "aligned_allocator alignment must be a power of two");
+
+	public:
+		using value_type = T;
+		using is_always_equal = std::true_type;
+		static constexpr size_t alignment = std::max(Align, alignof(T));
+
+		template <typename U>
+		struct rebind
+		{
+			using other = aligned_allocator<U, Align>;
+		};
+
+		aligned_allocator() noexcept = default;
+		template <typename U>
+		aligned_allocator(const aligned_allocator<U, Align>&) noexcept
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(T))
+				throw std::bad_array_new_length();
+
+			return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ alignment }));
+		}
+		void deallocate(T* ptr, size_t) noexcept
+		{
+			::operator delete(ptr, std::align_val_t{ alignment });
+		}
+	};
+
+	template <typename T, typename U, size_t Align>
+	bool operator==(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) noexcept
+	{
+		return true;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "Memory.hpp"
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+namespace mtl
+{
+	// Value wrapper whose copies share one T until someone writes. write()
+	// clones only when the storage is shared, so a value passed through many
+	// hands is copied at most once per writer instead of once per hand-off.
+	//
+	// Thread safety follows shared_ptr: different cow objects may be read and
+	// written from different threads even when they share storage, while one
+	// cow object needs external synchronization like any other value. A
+	// reference from write() must not be used once *this has been copied,
+	// since the copy shares what it points at. A moved-from cow is
+	// valueless and may only be assigned to or destroyed.
+	//
+	// Policy is limited to counts whose use_count() of 1 proves the other
+	// owners are gone. A biased count sums two halves with relaxed loads and
+	// may still owe decrements queued on its owner thread, so neither the
+	// total nor its ordering can be trusted there.
+	template <non_array T, typename Policy = atomic_ref_count>
+		requires (std::is_same_v<Policy, atomic_ref_count> || std::is_same_v<Policy, local_ref_count>)
+	class cow
+	{
+	public:
+		using value_type = T;
+
+		cow()
+			: m_Data(make_shared<T, Policy>())
+		{
+		}
+		cow(const T& value)
+			: m_Data(make_shared<T, Policy>(value))
+		{
+		}
+		cow(T&& value)
+			: m_Data(make_shared<T, Policy>(std::move(value)))
+		{
+		}
+		template <typename... Args>
+		explicit cow(std::in_place_t, Args&&... args)
+			: m_Data(make_shared<T, Policy>(std::forward<Args>(args)...))
+		{
+		}
+		cow(const cow&) = default;
+		cow(cow&&) noexcept = default;
+		cow& operator=(const cow&) = default;
+		cow& operator=(cow&&) noexcept = default;
+		cow& operator=(const T& value)
+		{
+			if (unique())
+				*m_Data = value;
+			else
+				m_Data = make_shared<T, Policy>(value);
+			return *this;
+		}
+		cow& operator=(T&& value)
+		{
+			if (unique())
+				*m_Data = std::move(value);
+			else
+				m_Data = make_shared<T, Policy>(std::move(value));
+			return *this;
+		}
+
+		const T& read() const noexcept
+		{
+			return *m_Data;
+		}
+		const T& operator*() const noexcept
+		{
+			return *m_Data;
+		}
+		const T* operator->() const noexcept
+		{
+			return m_Data.get();
+		}
+		// Mutable access; clones first if the storage is shared.
+		T& write()
+		{
+			if (!unique())
+				m_Data = make_shared<T, Policy>(std::as_const(*m_Data));
+			return *m_Data;
+		}
+
+		// The acquire fence pairs with the release in the decrement that made
+		// the count 1, so reads other owners made before letting go happen
+		// before our writes.
+		bool unique() const noexcept
+		{
+			if (m_Data.use_count() != 1)
+				return false;
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return true;
+		}
+		size_t use_count() const noexcept
+		{
+			return m_Data.use_count();
+		}
+		bool shares_with(const cow& rhs) const noexcept
+		{
+			return m_Data.get() == rhs.m_Data.get();
+		}
+		bool valueless_after_move() const noexcept
+		{
+			return !m_Data;
+		}
+
+		friend bool operator==(const cow& lhs, const cow& rhs)
+		{
+			return lhs.shares_with(rhs) || *lhs == *rhs;
+		}
+		friend bool operator==(const cow& lhs, const T& rhs)
+		{
+			return *lhs == rhs;
+		}
+		friend void swap(cow& lhs, cow& rhs) noexcept
+		{
+			swap(lhs.m_Data, rhs.m_Data);
+		}
+
+	private:
+		shared_ptr<T, Policy> m_Data;
+	};
+}
@@ -0,0 +1,261 @@
+#pragma once
+#include "Memory.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mtl
+{
+	struct reclamation_stats
+	{
+		size_t enqueued{ 0 };
+		size_t reclaimed{ 0 };
+		size_t depth{ 0 };
+		size_t max_depth{ 0 };
+		// From the last release to the end of the object's destruction.
+		std::chrono::nanoseconds total_latency{ 0 };
+		std::chrono::nanoseconds max_latency{ 0 };
+	};
+
+	namespace detail
+	{
+		// Intrusive queue link, embedded in whatever is being destroyed so
+		// that queueing it never allocates.
+		struct reclamation_job
+		{
+			void (*run)(void*);
+			void* context;
+			reclamation_job* next{ nullptr };
+			std::chrono::steady_clock::time_point enqueued;
+		};
+	}
+
+	// Destructions handed off by deferred shared_ptrs. They run on whichever
+	// thread calls drain(), or on a background thread after start().
+	class reclamation_queue
+	{
+		using clock = std::chrono::steady_clock;
+
+	public:
+		reclamation_queue() = default;
+		~reclamation_queue()
+		{
+			stop();
+			drain();
+		}
+		reclamation_queue(const reclamation_queue&) = delete;
+		reclamation_queue& operator=(const reclamation_queue&) = delete;
+
+		// Links the job in; called from release paths, so it cannot fail.
+		void push(detail::reclamation_job& job) noexcept
+		{
+			job.next = nullptr;
+			job.enqueued = clock::now();
+			{
+				std::lock_guard lock(m_Mutex);
+				if (m_Tail)
+					m_Tail->next = &job;
+				else
+					m_Head = &job;
+				m_Tail = &job;
+				++m_Depth;
+				++m_Stats.enqueued;
+				m_Stats.max_depth = std::max(m_Stats.max_depth, m_Depth);
+			}
+			m_Wakeup.notify_one();
+		}
+		// Runs every queued destruction, including ones queued while draining,
+		// and returns how many ran.
+		size_t drain()
+		{
+			size_t total = 0;
+			while (true)
+			{
+				detail::reclamation_job* batch;
+				{
+					std::lock_guard lock(m_Mutex);
+					batch = std::exchange(m_Head, nullptr);
+					m_Tail = nullptr;
+					m_Depth = 0;
+				}
+				if (!batch)
+					return total;
+
+				while (batch)
+				{
+					// Running the job may free the memory it lives in.
+					detail::reclamation_job* next = batch->next;
+					clock::time_point enqueued = batch->enqueued;
+					batch->run(batch->context);
+					Record(clock::now() - enqueued);
+					batch = next;
+					++total;
+				}
+			}
+		}
+		// Starts a thread that drains the queue whenever it is non-empty.
+		void start()
+		{
+			std::lock_guard lock(m_Mutex);
+			if (m_Worker.joinable())
+				return;
+
+			m_Stopping = false;
+			m_Worker = std::thread([this] {
+				std::unique_lock lock(m_Mutex);
+				while (true)
+				{
+					m_Wakeup.wait(lock, [this] { return m_Stopping || m_Head; });
+					if (m_Stopping)
+						return;
+
+					lock.unlock();
+					drain();
+					lock.lock();
+				}
+			});
+		}
+		// Stops the background thread; queued destructions stay queued.
+		void stop()
+		{
+			std::thread worker;
+			{
+				std::lock_guard lock(m_Mutex);
+				m_Stopping = true;
+				worker = std::move(m_Worker);
+			}
+			m_Wakeup.notify_all();
+			if (worker.joinable())
+				worker.join();
+		}
+		size_t depth() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Depth;
+		}
+		reclamation_stats stats() const
+		{
+			std::lock_guard lock(m_Mutex);
+			reclamation_stats stats = m_Stats;
+			stats.depth = m_Depth;
+			return stats;
+		}
+
+	private:
+		void Record(clock::duration latency)
+		{
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency);
+			std::lock_guard lock(m_Mutex);
+			++m_Stats.reclaimed;
+			m_Stats.total_latency += ns;
+			m_Stats.max_latency = std::max(m_Stats.max_latency, ns);
+		}
+
+	private:
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_Wakeup;
+		detail::reclamation_job* m_Head{ nullptr };
+		detail::reclamation_job* m_Tail{ nullptr };
+		size_t m_Depth{ 0 };
+		reclamation_stats m_Stats;
+		std::thread m_Worker;
+		bool m_Stopping{ false };
+	};
+
+	inline reclamation_queue& default_reclamation_queue()
+	{
+		// Never destroyed: shared_ptrs may be released from static destructors.
+		static reclamation_queue* queue = new reclamation_queue();
+		return *queue;
+	}
+
+	namespace detail
+	{
+		// Like control_block_shared, but the last strong release only queues
+		// the destruction. The queued job holds a weak reference, so the block
+		// is freed by whichever of the job and the last weak_ptr finishes last.
+		template <typename T, typename Alloc, typename Policy>
+		class control_block_deferred : public control_block_base<Policy>
+		{
+			using alloc_traits = std::allocator_traits<Alloc>;
+			using block_alloc = typename alloc_traits::template rebind_alloc<control_block_deferred>;
+			using block_traits = std::allocator_traits<block_alloc>;
+
+		public:
+			template <typename... Args>
+			static control_block_deferred* Create(reclamation_queue& queue, const Alloc& alloc, Args&&... args)
+			{
+				block_alloc allocator(alloc);
+				auto block = std::to_address(block_traits::allocate(allocator, 1));
+				try
+				{
+					return new (block) control_block_deferred(queue, alloc, std::forward<Args>(args)...);
+				}
+				catch (...)
+				{
+					block_traits::deallocate(allocator, block, 1);
+					throw;
+				}
+			}
+			void Destroy() override
+			{
+				this->IncWeakRef();
+				m_Queue.push(m_Job);
+			}
+			void DeleteThis() override
+			{
+				block_alloc allocator(m_Allocator);
+				this->~control_block_deferred();
+				block_traits::deallocate(allocator, this, 1);
+			}
+			T* ObjPtr()
+			{
+				return reinterpret_cast<T*>(&m_Data);
+			}
+
+		private:
+			template <typename... Args>
+			control_block_deferred(reclamation_queue& queue, const Alloc& alloc, Args&&... args)
+				: m_Queue(queue), m_Allocator(alloc)
+			{
+				m_Job.run = &Reclaim;
+				m_Job.context = this;
+				alloc_traits::construct(m_Allocator, ObjPtr(), std::forward<Args>(args)...);
+			}
+			static void Reclaim(void* block)
+			{
+				auto self = static_cast<control_block_deferred*>(block);
+				alloc_traits::destroy(self->m_Allocator, self->ObjPtr());
+				self->DecWeakRef();
+			}
+
+		private:
+			reclamation_queue& m_Queue;
+			reclamation_job m_Job;
+			MTL_NO_UNIQUE_ADDRESS Alloc m_Allocator;
+			alignas(T) std::byte m_Data[sizeof(T)];
+		};
+	}
+
+	// A shared_ptr whose last release queues the destruction of the object
+	// on `queue` instead of running it inline.
+	template <non_array T, typename Policy = atomic_ref_count, typename Alloc, typename... Args>
+	shared_ptr<T, Policy> allocate_shared_deferred(reclamation_queue& queue, const Alloc& alloc, Args&&... args)
+	{
+		// The queue may drain on its background thread, which drops the job's
+		// weak reference while weak_ptrs on the owning thread touch the same
+		// count, so the count has to be atomic.
+		static_assert(!std::is_same_v<Policy, local_ref_count>, "deferred destruction needs a thread-safe reference count policy");
+
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_deferred<T, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::Create(queue, allocator(alloc), std::forward<Args>(args)...));
+	}
+	template <non_array T, typename Policy = atomic_ref_count, typename... Args>
+	shared_ptr<T, Policy> make_shared_deferred(reclamation_queue& queue, Args&&... args)
+	{
+		return allocate_shared_deferred<T, Policy>(queue, std::allocator<T>(), std::forward<Args>(args)...);
+	}
+}
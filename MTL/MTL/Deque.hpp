@@ -1,73 +1,135 @@
+#pragma once
 #include <utility>
 #include <iterator>
+#include <memory>
 
 namespace mtl
 {
 	template <typename T>
+	class polymorphic_allocator;
+
+	template <typename T, typename Alloc = std::allocator<T>>
 	class deque
 	{
+		using alloc_traits = std::allocator_traits<Alloc>;
+		// Blocks and the map are held through the allocator's pointer type, so
+		// a deque can live in shared memory with offset_ptr links.
+		using block_pointer = typename alloc_traits::pointer;
+		using map_alloc = typename alloc_traits::template rebind_alloc<block_pointer>;
+		using map_traits = std::allocator_traits<map_alloc>;
+		using map_pointer = typename map_traits::pointer;
+
 	public:
 		class iterator;
+		using allocator_type = Alloc;
 		static constexpr size_t BLOCK_SIZE{ 8 };
 
 		deque()
+			: deque(Alloc())
 		{
-			m_Map = new T*[m_MapCapacity];
-			for (size_t i = 0; i < m_MapCapacity; ++i)
-				m_Map[i] = nullptr;
-
+		}
+		explicit deque(const Alloc& alloc)
+			: m_Allocator(alloc)
+		{
+			m_Map = allocate_map(m_MapCapacity);
 			m_FrontBlock = m_BackBlock = m_MapCapacity / 2;
-			m_Map[m_FrontBlock] = static_cast<T*>(::operator new[](BLOCK_SIZE * sizeof(T)));
+			m_Map[m_FrontBlock] = alloc_traits::allocate(m_Allocator, BLOCK_SIZE);
 		}
 		~deque()
 		{
-			clear();
-			for (size_t i = m_FrontBlock; i < m_BackBlock; ++i)
-				::operator delete[](m_Map[i]);
+			if (!m_Map)
+				return;
 
-			delete[] m_Map;
+			clear();
+			for (size_t i = 0; i < m_MapCapacity; ++i)
+			{
+				if (m_Map[i])
+					alloc_traits::deallocate(m_Allocator, m_Map[i], BLOCK_SIZE);
+			}
+			deallocate_map(m_Map, m_MapCapacity);
 		}
-		deque(std::initializer_list<T> list)
-			: deque()
+		deque(std::initializer_list<T> list, const Alloc& alloc = Alloc())
+			: deque(alloc)
 		{
 			for (auto& val : list)
 				push_back(val);
 		}
 		deque(const deque& rhs)
-			: m_MapCapacity(rhs.m_MapCapacity), m_Size(rhs.m_Size), m_FrontBlock(rhs.m_FrontBlock)
-			, m_FrontPos(rhs.m_FrontPos), m_BackBlock(rhs.m_BackBlock), m_BackPos(rhs.m_BackPos)
+			: deque(rhs, alloc_traits::select_on_container_copy_construction(rhs.m_Allocator))
 		{
-			m_Map = new T*[m_MapCapacity];
-			for (size_t i = 0; i < m_MapCapacity; ++i)
+		}
+		deque(const deque& rhs, const Alloc& alloc)
+			: m_MapCapacity(rhs.m_MapCapacity), m_FrontBlock(rhs.m_FrontBlock), m_BackBlock(rhs.m_BackBlock)
+			, m_FrontPos(rhs.m_FrontPos), m_BackPos(rhs.m_BackPos), m_Allocator(alloc)
+		{
+			m_Map = allocate_map(m_MapCapacity);
+			for (size_t i = m_FrontBlock; i <= m_BackBlock; ++i)
 			{
-				if (rhs.m_Map[i])
+				m_Map[i] = alloc_traits::allocate(m_Allocator, BLOCK_SIZE);
+				size_t start = (i == m_FrontBlock) ? m_FrontPos : 0;
+				size_t end = (i == m_BackBlock) ? m_BackPos : BLOCK_SIZE;
+				for (; start < end; ++start)
 				{
-					m_Map[i] = static_cast<T*>(::operator new[](BLOCK_SIZE * sizeof(T)));
-					size_t start = (i == m_FrontBlock) ? m_FrontPos : 0;
-					size_t end = (i == m_BackBlock) ? m_BackPos : BLOCK_SIZE;
-					for (; start < end; ++start)
-						new (&m_Map[i][start]) T(rhs.m_Map[i][start]);
+					alloc_traits::construct(m_Allocator, &m_Map[i][start], rhs.m_Map[i][start]);
+					++m_Size;
 				}
-				else
-					m_Map[i] = nullptr;
 			}
 		}
 		deque(deque&& rhs) noexcept
+			: m_Allocator(rhs.m_Allocator)
+		{
+			swap_contents(rhs);
+		}
+		deque(deque&& rhs, const Alloc& alloc)
+			: deque(alloc)
+		{
+			if (m_Allocator == rhs.m_Allocator)
+			{
+				swap_contents(rhs);
+			}
+			else
+			{
+				for (size_t i = 0; i < rhs.m_Size; ++i)
+					push_back(std::move(rhs[i]));
+			}
+		}
+		// Assignment keeps this deque's allocator unless the allocator asks
+		// to propagate, so blocks are always freed into the resource they
+		// came from.
+		deque& operator=(const deque& rhs)
 		{
-			swap(*this, rhs);
+			if (this != &rhs)
+			{
+				deque tmp(rhs, alloc_traits::propagate_on_container_copy_assignment::value ? rhs.m_Allocator : m_Allocator);
+				swap(*this, tmp);
+			}
+			return *this;
 		}
-		deque& operator=(deque rhs) noexcept
+		deque& operator=(deque&& rhs) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
 		{
-			swap(*this, rhs);
+			if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+			{
+				deque tmp(std::move(rhs));
+				swap(*this, tmp);
+			}
+			else
+			{
+				deque tmp(std::move(rhs), m_Allocator);
+				swap(*this, tmp);
+			}
 			return *this;
 		}
+		allocator_type get_allocator() const noexcept
+		{
+			return m_Allocator;
+		}
 		void push_back(const T& value)
 		{
 			if (m_BackPos == BLOCK_SIZE)
 			{
 				allocate_back();
 			}
-			new (&m_Map[m_BackBlock][m_BackPos++]) T(value);
+			alloc_traits::construct(m_Allocator, &m_Map[m_BackBlock][m_BackPos++], value);
 			++m_Size;
 		}
 		void push_back(T&& value)
@@ -76,7 +138,7 @@ namespace mtl
 			{
 				allocate_back();
 			}
-			new (&m_Map[m_BackBlock][m_BackPos++]) T(std::move(value));
+			alloc_traits::construct(m_Allocator, &m_Map[m_BackBlock][m_BackPos++], std::move(value));
 			++m_Size;
 		}
 		template <typename... Args>
@@ -86,7 +148,7 @@ namespace mtl
 			{
 				allocate_back();
 			}
-			new (&m_Map[m_BackBlock][m_BackPos++]) T(std::forward<Args>(args)...);
+			alloc_traits::construct(m_Allocator, &m_Map[m_BackBlock][m_BackPos++], std::forward<Args>(args)...);
 			++m_Size;
 		}
 		void pop_back()
@@ -98,7 +160,7 @@ namespace mtl
 				--m_BackBlock;
 				m_BackPos = BLOCK_SIZE;
 			}
-			m_Map[m_BackBlock][--m_BackPos].~T();
+			alloc_traits::destroy(m_Allocator, &m_Map[m_BackBlock][--m_BackPos]);
 			if (--m_Size == 0)
 				reset_offsets();
 		}
@@ -108,7 +170,7 @@ namespace mtl
 			{
 				allocate_front();
 			}
-			new (&m_Map[m_FrontBlock][--m_FrontPos]) T(value);
+			alloc_traits::construct(m_Allocator, &m_Map[m_FrontBlock][--m_FrontPos], value);
 			++m_Size;
 		}
 		void push_front(T&& value)
@@ -117,7 +179,7 @@ namespace mtl
 			{
 				allocate_front();
 			}
-			new (&m_Map[m_FrontBlock][--m_FrontPos]) T(std::move(value));
+			alloc_traits::construct(m_Allocator, &m_Map[m_FrontBlock][--m_FrontPos], std::move(value));
 			++m_Size;
 		}
 		template <typename... Args>
@@ -127,14 +189,14 @@ namespace mtl
 			{
 				allocate_front();
 			}
-			new (&m_Map[m_FrontBlock][--m_FrontPos]) T(std::forward<Args>(args)...);
+			alloc_traits::construct(m_Allocator, &m_Map[m_FrontBlock][--m_FrontPos], std::forward<Args>(args)...);
 			++m_Size;
 		}
 		void pop_front()
 		{
 			if (m_Size == 0)
 				return;
-			m_Map[m_FrontBlock][m_FrontPos++].~T();
+			alloc_traits::destroy(m_Allocator, &m_Map[m_FrontBlock][m_FrontPos++]);
 			if (--m_Size == 0)
 			{
 				reset_offsets();
@@ -156,7 +218,7 @@ namespace mtl
 		void clear()
 		{
 			for (size_t i = 0; i < m_Size; ++i)
-				operator[](i).~T();
+				alloc_traits::destroy(m_Allocator, &operator[](i));
 
 			m_Size = 0;
 		}
@@ -176,11 +238,11 @@ namespace mtl
 		}
 		iterator begin() const
 		{
-			return iterator(m_Map + m_FrontBlock, m_Map[m_FrontBlock] + m_FrontPos);
+			return iterator(std::to_address(m_Map) + m_FrontBlock, std::to_address(m_Map[m_FrontBlock]) + m_FrontPos);
 		}
 		iterator end() const
 		{
-			return iterator(m_Map + m_BackBlock, m_Map[m_BackBlock] + m_BackPos);
+			return iterator(std::to_address(m_Map) + m_BackBlock, std::to_address(m_Map[m_BackBlock]) + m_BackPos);
 		}
 		T& front() const
 		{
@@ -202,10 +264,10 @@ namespace mtl
 			using reference = T&;
 
 			iterator() = default;
-			iterator(T** block_, T* cur_)
+			iterator(block_pointer* block_, T* cur_)
 				: block(block_), cur(cur_)
 			{
-				front = *block;
+				front = std::to_address(*block);
 				back = front + BLOCK_SIZE;
 			}
 			reference operator*() const
@@ -328,37 +390,51 @@ namespace mtl
 			}
 
 		private:
-			void set_block(T** block)
+			void set_block(block_pointer* block)
 			{
 				this->block = block;
-				front = *block;
+				front = std::to_address(*block);
 				back = front + BLOCK_SIZE;
 			}
 
 		private:
-			T** block{ nullptr };
+			block_pointer* block{ nullptr };
 			T* cur{ nullptr };
 			T* front{ nullptr };
 			T* back{ nullptr };
 		};
 
 	private:
-		void reallocate_map(size_t new_map_capacity)
+		map_pointer allocate_map(size_t capacity)
 		{
-			T** new_map = new T*[new_map_capacity];
-			for (size_t i = 0; i < new_map_capacity; ++i)
-				new_map[i] = nullptr;
+			map_alloc allocator(m_Allocator);
+			map_pointer map = map_traits::allocate(allocator, capacity);
+			for (size_t i = 0; i < capacity; ++i)
+				map_traits::construct(allocator, &map[i], nullptr);
 
-			size_t new_front_block = (new_map_capacity - m_MapCapacity) / 2;
-			size_t map_size = m_BackBlock - m_FrontBlock + 1;
-			for (size_t i = 0; i < map_size; ++i)
-				new_map[new_front_block + i] = m_Map[m_FrontBlock + i];
+			return map;
+		}
+		void deallocate_map(map_pointer map, size_t capacity)
+		{
+			map_alloc allocator(m_Allocator);
+			for (size_t i = 0; i < capacity; ++i)
+				map_traits::destroy(allocator, &map[i]);
+			map_traits::deallocate(allocator, map, capacity);
+		}
+		// Keeps every block, including spare ones outside [front, back], so
+		// none of them leak.
+		void reallocate_map(size_t new_map_capacity)
+		{
+			map_pointer new_map = allocate_map(new_map_capacity);
+			size_t shift = (new_map_capacity - m_MapCapacity) / 2;
+			for (size_t i = 0; i < m_MapCapacity; ++i)
+				new_map[shift + i] = m_Map[i];
 
-			delete[] m_Map;
+			deallocate_map(m_Map, m_MapCapacity);
 			m_Map = new_map;
 			m_MapCapacity = new_map_capacity;
-			m_FrontBlock = new_front_block;
-			m_BackBlock = m_FrontBlock + map_size - 1;
+			m_FrontBlock += shift;
+			m_BackBlock += shift;
 		}
 		void reset_offsets()
 		{
@@ -370,7 +446,7 @@ namespace mtl
 			if (m_BackBlock + 1 == m_MapCapacity)
 				reallocate_map(m_MapCapacity * 2);
 			if (m_Map[++m_BackBlock] == nullptr)
-				m_Map[m_BackBlock] = static_cast<T*>(::operator new[](BLOCK_SIZE * sizeof(T)));
+				m_Map[m_BackBlock] = alloc_traits::allocate(m_Allocator, BLOCK_SIZE);
 			m_BackPos = 0;
 		}
 		void allocate_front()
@@ -378,26 +454,38 @@ namespace mtl
 			if (m_FrontBlock == 0)
 				reallocate_map(m_MapCapacity * 2);
 			if (m_Map[--m_FrontBlock] == nullptr)
-				m_Map[m_FrontBlock] = static_cast<T*>(::operator new[](BLOCK_SIZE * sizeof(T)));
+				m_Map[m_FrontBlock] = alloc_traits::allocate(m_Allocator, BLOCK_SIZE);
 			m_FrontPos = BLOCK_SIZE;
 		}
+		void swap_contents(deque& rhs) noexcept
+		{
+			std::swap(m_Map, rhs.m_Map);
+			std::swap(m_MapCapacity, rhs.m_MapCapacity);
+			std::swap(m_Size, rhs.m_Size);
+			std::swap(m_FrontBlock, rhs.m_FrontBlock);
+			std::swap(m_BackBlock, rhs.m_BackBlock);
+			std::swap(m_FrontPos, rhs.m_FrontPos);
+			std::swap(m_BackPos, rhs.m_BackPos);
+		}
 		friend void swap(deque& lhs, deque& rhs) noexcept
 		{
-			std::swap(lhs.m_Map, rhs.m_Map);
-			std::swap(lhs.m_MapCapacity, rhs.m_MapCapacity);
-			std::swap(lhs.m_Size, rhs.m_Size);
-			std::swap(lhs.m_FrontBlock, rhs.m_FrontBlock);
-			std::swap(lhs.m_BackBlock, rhs.m_BackBlock);
-			std::swap(lhs.m_FrontPos, rhs.m_FrontPos);
-			std::swap(lhs.m_BackPos, rhs.m_BackPos);
+			lhs.swap_contents(rhs);
+			std::swap(lhs.m_Allocator, rhs.m_Allocator);
 		}
 	private:
 		static constexpr size_t MAP_MINIMUM_SIZE{ 8 };
 
-		T** m_Map{ nullptr };
+		map_pointer m_Map{ nullptr };
 		size_t m_MapCapacity{ MAP_MINIMUM_SIZE };
 		size_t m_Size{ 0 };
 		size_t m_FrontBlock = 0, m_BackBlock = 0;
 		size_t m_FrontPos = BLOCK_SIZE / 2, m_BackPos = BLOCK_SIZE / 2;
+		Alloc m_Allocator;
 	};
+
+	namespace pmr
+	{
+		template <typename T>
+		using deque = mtl::deque<T, polymorphic_allocator<T>>;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,313 @@
+#pragma once
+#include "CacheLine.hpp"
+#include "Memory.hpp"
+#include "ReclamationDomain.hpp"
+#include <concepts>
+#include <thread>
+
+namespace mtl
+{
+	class epoch_domain;
+	class epoch_guard;
+	epoch_domain& epoch_default_domain() noexcept;
+
+	namespace detail
+	{
+		// Written by its thread on every pin; aligned so neighbouring
+		// participants do not share a cache line.
+		struct alignas(hardware_destructive_interference_size) epoch_participant
+		{
+			static constexpr std::uint64_t PINNED{ 1 };
+
+			// Objects retired while the global epoch was `epoch`.
+			struct bag
+			{
+				std::uint64_t epoch{ 0 };
+				mtl::vector<retired_object> objects;
+			};
+
+			// (epoch << 1) | PINNED while pinned, 0 otherwise.
+			std::atomic<std::uint64_t> state{ 0 };
+			size_t nesting{ 0 };
+			size_t operations{ 0 };
+			bag bags[3];
+			std::atomic<bool> owned{ false };
+			epoch_participant* next{ nullptr };
+		};
+	}
+
+	// Keeps the calling thread pinned in its domain's current epoch. Objects
+	// retired after the guard was taken stay alive until it is dropped.
+	class epoch_guard
+	{
+		friend class epoch_domain;
+
+	public:
+		~epoch_guard();
+		epoch_guard(const epoch_guard&) = delete;
+		epoch_guard& operator=(const epoch_guard&) = delete;
+
+		epoch_domain& domain() const noexcept
+		{
+			return m_Domain;
+		}
+
+	private:
+		epoch_guard(epoch_domain& domain, detail::epoch_participant& participant) noexcept
+			: m_Domain(domain), m_Participant(participant)
+		{
+		}
+
+	private:
+		epoch_domain& m_Domain;
+		detail::epoch_participant& m_Participant;
+	};
+
+	// Epoch-based reclamation: an object retired in epoch e is reclaimed once
+	// the global epoch reaches e + 2, since by then every thread has left the
+	// critical sections that might have seen it. Pinning costs a store and a
+	// fence per critical section rather than per pointer read.
+	class epoch_domain
+	{
+		friend class epoch_guard;
+
+		static constexpr size_t COLLECT_INTERVAL{ 64 };
+
+	public:
+		epoch_domain()
+			: m_Id(detail::domain_registry::get().add())
+		{
+		}
+		// Requires that no thread is pinned in or retiring through the domain.
+		~epoch_domain()
+		{
+			detail::domain_registry::get().remove(m_Id);
+			for (auto participant = m_Participants.load(std::memory_order_acquire); participant; participant = participant->next)
+			{
+				for (auto& bag : participant->bags)
+				{
+					for (auto& object : bag.objects)
+						object.reclaim(object.ptr);
+				}
+			}
+			detail::destroy_slots(m_Participants);
+		}
+		epoch_domain(const epoch_domain&) = delete;
+		epoch_domain& operator=(const epoch_domain&) = delete;
+
+		epoch_guard pin()
+		{
+			detail::epoch_participant& participant = local_participant();
+			if (participant.nesting++ == 0)
+			{
+				std::uint64_t epoch = m_Epoch.load(std::memory_order_relaxed);
+				participant.state.store((epoch << 1) | detail::epoch_participant::PINNED, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (++participant.operations % COLLECT_INTERVAL == 0)
+					collect(participant);
+			}
+			return epoch_guard(*this, participant);
+		}
+		// ptr must already be unreachable for readers that pin after this call.
+		void retire(void* ptr, void (*reclaim)(void*))
+		{
+			detail::epoch_participant& participant = local_participant();
+			std::uint64_t epoch = m_Epoch.load(std::memory_order_acquire);
+			auto& bag = participant.bags[epoch % 3];
+			if (bag.epoch != epoch)
+			{
+				// The slot last held epoch - 3 or older, which is safe to free.
+				reclaim_bag(bag);
+				bag.epoch = epoch;
+			}
+			bag.objects.push_back({ ptr, reclaim });
+			m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+			if (++participant.operations % COLLECT_INTERVAL == 0)
+				collect(participant);
+		}
+		template <typename T>
+		void retire(T* ptr)
+		{
+			retire(ptr, [](void* object) { default_delete<T>()(static_cast<T*>(object)); });
+		}
+		// Tries to move the global epoch forward; fails while a thread is
+		// still pinned in an older epoch.
+		bool try_advance() noexcept
+		{
+			std::uint64_t epoch = m_Epoch.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			for (auto participant = m_Participants.load(std::memory_order_acquire); participant; participant = participant->next)
+			{
+				std::uint64_t state = participant->state.load(std::memory_order_acquire);
+				if ((state & detail::epoch_participant::PINNED) && (state >> 1) != epoch)
+					return false;
+			}
+			// Losing the race means another thread advanced it for us.
+			m_Epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+			return true;
+		}
+		// Advances the epoch twice, then reclaims what the calling thread and
+		// exited threads retired before the call. Objects retired by other
+		// live threads are only safe to reclaim from now on; those threads
+		// free them on their next collection. Must not be called while pinned.
+		void synchronize()
+		{
+			std::uint64_t target = m_Epoch.load(std::memory_order_acquire) + 2;
+			while (m_Epoch.load(std::memory_order_acquire) < target)
+			{
+				if (!try_advance())
+					std::this_thread::yield();
+			}
+			reclaim_expired(local_participant());
+			for (auto participant = m_Participants.load(std::memory_order_acquire); participant; participant = participant->next)
+			{
+				if (!participant->owned.load(std::memory_order_relaxed) && !participant->owned.exchange(true, std::memory_order_acquire))
+				{
+					reclaim_expired(*participant);
+					detail::release_slot(participant);
+				}
+			}
+		}
+		std::uint64_t epoch() const noexcept
+		{
+			return m_Epoch.load(std::memory_order_relaxed);
+		}
+		size_t pending_reclamations() const noexcept
+		{
+			return m_Pending.load(std::memory_order_relaxed);
+		}
+
+	private:
+		detail::epoch_participant& local_participant()
+		{
+			return detail::thread_slots<detail::epoch_participant>::local(this, m_Id, m_Participants);
+		}
+		void unpin(detail::epoch_participant& participant) noexcept
+		{
+			if (--participant.nesting == 0)
+				participant.state.store(0, std::memory_order_release);
+		}
+		void collect(detail::epoch_participant& participant)
+		{
+			try_advance();
+			reclaim_expired(participant);
+		}
+		void reclaim_expired(detail::epoch_participant& participant)
+		{
+			std::uint64_t epoch = m_Epoch.load(std::memory_order_acquire);
+			for (auto& bag : participant.bags)
+			{
+				if (bag.epoch + 2 <= epoch)
+					reclaim_bag(bag);
+			}
+		}
+		void reclaim_bag(detail::epoch_participant::bag& bag)
+		{
+			// Reclaimers may retire more objects into the same participant.
+			mtl::vector<detail::retired_object> objects;
+			swap(objects, bag.objects);
+			for (auto& object : objects)
+				object.reclaim(object.ptr);
+
+			m_Pending.fetch_sub(objects.size(), std::memory_order_relaxed);
+		}
+
+	private:
+		std::uint64_t m_Id;
+		std::atomic<std::uint64_t> m_Epoch{ 0 };
+		std::atomic<detail::epoch_participant*> m_Participants{ nullptr };
+		std::atomic<size_t> m_Pending{ 0 };
+	};
+
+	inline epoch_guard::~epoch_guard()
+	{
+		m_Domain.unpin(m_Participant);
+	}
+
+	inline epoch_domain& epoch_default_domain() noexcept
+	{
+		// Never destroyed: objects may be retired from static destructors.
+		static epoch_domain* domain = new epoch_domain();
+		return *domain;
+	}
+
+	// A single published value with read-copy-update semantics: readers pin
+	// the domain and dereference without touching any shared counter, while
+	// writers swap in a new value and retire the old one.
+	template <non_array T>
+	class rcu_cell
+	{
+	public:
+		explicit rcu_cell(epoch_domain& domain = epoch_default_domain()) noexcept
+			: m_Domain(domain)
+		{
+		}
+		explicit rcu_cell(unique_ptr<T> value, epoch_domain& domain = epoch_default_domain()) noexcept
+			: m_Domain(domain), m_Value(value.release())
+		{
+		}
+		// Requires that no reader still holds a pointer from this cell.
+		~rcu_cell()
+		{
+			default_delete<T>()(m_Value.load(std::memory_order_relaxed));
+		}
+		rcu_cell(const rcu_cell&) = delete;
+		rcu_cell& operator=(const rcu_cell&) = delete;
+
+		// The result stays valid for as long as guard is held.
+		const T* read(const epoch_guard& guard) const noexcept
+		{
+			(void)guard;
+			return m_Value.load(std::memory_order_acquire);
+		}
+		template <typename F>
+			requires std::is_invocable_v<F, const T*>
+		decltype(auto) read(F&& reader) const
+		{
+			epoch_guard guard = m_Domain.pin();
+			return std::forward<F>(reader)(read(guard));
+		}
+		void store(unique_ptr<T> value)
+		{
+			retire(m_Value.exchange(value.release(), std::memory_order_acq_rel));
+		}
+		// Copies the current value, applies updater to the copy and publishes
+		// it, retrying if another writer got there first. An empty cell starts
+		// from a default-constructed T.
+		template <typename F>
+			requires std::copy_constructible<T> && std::default_initializable<T> && std::is_invocable_v<F&, T&>
+		void update(F&& updater)
+		{
+			epoch_guard guard = m_Domain.pin();
+			T* current = m_Value.load(std::memory_order_acquire);
+			while (true)
+			{
+				unique_ptr<T> next = current ? make_unique<T>(*current) : make_unique<T>();
+				updater(*next);
+				if (m_Value.compare_exchange_strong(current, next.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					next.release();
+					retire(current);
+					return;
+				}
+			}
+		}
+		epoch_domain& domain() const noexcept
+		{
+			return m_Domain;
+		}
+
+	private:
+		void retire(T* value)
+		{
+			if (value)
+				m_Domain.retire(value);
+		}
+
+	private:
+		epoch_domain& m_Domain;
+		std::atomic<T*> m_Value{ nullptr };
+	};
+}
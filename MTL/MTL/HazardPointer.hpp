@@ -0,0 +1,262 @@
+#pragma once
+#include "CacheLine.hpp"
+#include "Memory.hpp"
+#include "ReclamationDomain.hpp"
+#include <algorithm>
+
+namespace mtl
+{
+	class hazard_pointer;
+	class hazard_pointer_domain;
+	hazard_pointer_domain& hazard_pointer_default_domain() noexcept;
+
+	namespace detail
+	{
+		// One per thread; aligned so that threads publishing into neighbouring
+		// records do not share a cache line.
+		struct alignas(hardware_destructive_interference_size) hazard_record
+		{
+			std::atomic<const void*> hazard{ nullptr };
+			std::atomic<bool> active{ false };
+			hazard_record* next{ nullptr };
+		};
+
+		struct retire_slot
+		{
+			mtl::vector<retired_object> retired;
+			std::atomic<bool> owned{ false };
+			retire_slot* next{ nullptr };
+		};
+	}
+
+	// Owns one hazard record of a domain. While it protects a pointer, no
+	// thread reclaims the object that pointer refers to.
+	class hazard_pointer
+	{
+		friend class hazard_pointer_domain;
+
+	public:
+		hazard_pointer() noexcept = default;
+		~hazard_pointer()
+		{
+			if (m_Record)
+			{
+				m_Record->hazard.store(nullptr, std::memory_order_release);
+				m_Record->active.store(false, std::memory_order_release);
+			}
+		}
+		hazard_pointer(const hazard_pointer&) = delete;
+		hazard_pointer(hazard_pointer&& rhs) noexcept
+			: m_Record(std::exchange(rhs.m_Record, nullptr))
+		{
+		}
+		hazard_pointer& operator=(hazard_pointer rhs) noexcept
+		{
+			std::swap(m_Record, rhs.m_Record);
+			return *this;
+		}
+
+		bool empty() const noexcept
+		{
+			return m_Record == nullptr;
+		}
+		template <typename T>
+		T* protect(const std::atomic<T*>& src) noexcept
+		{
+			T* ptr = src.load(std::memory_order_relaxed);
+			while (!try_protect(ptr, src))
+			{
+			}
+			return ptr;
+		}
+		// Publishes ptr as hazardous and confirms src still holds it. On
+		// failure ptr is updated to the current value of src.
+		template <typename T>
+		bool try_protect(T*& ptr, const std::atomic<T*>& src) noexcept
+		{
+			T* expected = ptr;
+			m_Record->hazard.store(expected, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			ptr = src.load(std::memory_order_acquire);
+			if (ptr == expected)
+				return true;
+
+			reset_protection();
+			return false;
+		}
+		template <typename T>
+		void reset_protection(const T* ptr) noexcept
+		{
+			m_Record->hazard.store(ptr, std::memory_order_release);
+		}
+		void reset_protection(std::nullptr_t = nullptr) noexcept
+		{
+			m_Record->hazard.store(nullptr, std::memory_order_release);
+		}
+
+	private:
+		explicit hazard_pointer(detail::hazard_record* record) noexcept
+			: m_Record(record)
+		{
+		}
+
+	private:
+		detail::hazard_record* m_Record{ nullptr };
+	};
+
+	class hazard_pointer_domain
+	{
+		static constexpr size_t MIN_SCAN_THRESHOLD{ 64 };
+
+	public:
+		hazard_pointer_domain()
+			: m_Id(detail::domain_registry::get().add())
+		{
+		}
+		// Requires that no thread still protects or retires through the domain.
+		~hazard_pointer_domain()
+		{
+			detail::domain_registry::get().remove(m_Id);
+			for (auto slot = m_Slots.load(std::memory_order_acquire); slot; slot = slot->next)
+			{
+				for (auto& object : slot->retired)
+					object.reclaim(object.ptr);
+			}
+			detail::destroy_slots(m_Slots);
+			detail::hazard_record* record = m_Records.load(std::memory_order_acquire);
+			while (record)
+				delete std::exchange(record, record->next);
+		}
+		hazard_pointer_domain(const hazard_pointer_domain&) = delete;
+		hazard_pointer_domain& operator=(const hazard_pointer_domain&) = delete;
+
+		hazard_pointer make_hazard_pointer()
+		{
+			for (auto record = m_Records.load(std::memory_order_acquire); record; record = record->next)
+			{
+				if (!record->active.load(std::memory_order_relaxed) && !record->active.exchange(true, std::memory_order_acquire))
+					return hazard_pointer(record);
+			}
+			auto record = new detail::hazard_record();
+			record->active.store(true, std::memory_order_relaxed);
+			record->next = m_Records.load(std::memory_order_relaxed);
+			while (!m_Records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+			m_RecordCount.fetch_add(1, std::memory_order_relaxed);
+			return hazard_pointer(record);
+		}
+		// Hands ptr to the domain; reclaim(ptr) runs once no hazard pointer
+		// protects it. ptr must already be unreachable for new readers.
+		void retire(void* ptr, void (*reclaim)(void*))
+		{
+			detail::retire_slot& slot = local_slot();
+			slot.retired.push_back({ ptr, reclaim });
+			m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+			size_t threshold = std::max(MIN_SCAN_THRESHOLD, 2 * m_RecordCount.load(std::memory_order_relaxed));
+			if (slot.retired.size() >= threshold)
+				scan(slot);
+		}
+		// Reclaims everything unprotected in this thread's list and in the
+		// lists of threads that have exited.
+		void cleanup()
+		{
+			scan(local_slot());
+			for (auto slot = m_Slots.load(std::memory_order_acquire); slot; slot = slot->next)
+			{
+				if (!slot->owned.load(std::memory_order_relaxed) && !slot->owned.exchange(true, std::memory_order_acquire))
+				{
+					scan(*slot);
+					detail::release_slot(slot);
+				}
+			}
+		}
+		size_t pending_reclamations() const noexcept
+		{
+			return m_Pending.load(std::memory_order_relaxed);
+		}
+
+	private:
+		detail::retire_slot& local_slot()
+		{
+			return detail::thread_slots<detail::retire_slot>::local(this, m_Id, m_Slots);
+		}
+		void scan(detail::retire_slot& slot)
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			mtl::vector<const void*> hazards;
+			for (auto record = m_Records.load(std::memory_order_acquire); record; record = record->next)
+			{
+				if (const void* hazard = record->hazard.load(std::memory_order_acquire))
+					hazards.push_back(hazard);
+			}
+			std::sort(hazards.data(), hazards.data() + hazards.size());
+
+			// Reclaimers may retire more objects into this slot.
+			mtl::vector<detail::retired_object> batch;
+			swap(batch, slot.retired);
+			for (auto& object : batch)
+			{
+				if (std::binary_search(hazards.data(), hazards.data() + hazards.size(), static_cast<const void*>(object.ptr)))
+				{
+					slot.retired.push_back(object);
+				}
+				else
+				{
+					object.reclaim(object.ptr);
+					m_Pending.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+	private:
+		std::uint64_t m_Id{ 0 };
+		std::atomic<detail::hazard_record*> m_Records{ nullptr };
+		std::atomic<size_t> m_RecordCount{ 0 };
+		std::atomic<detail::retire_slot*> m_Slots{ nullptr };
+		std::atomic<size_t> m_Pending{ 0 };
+	};
+
+	inline hazard_pointer_domain& hazard_pointer_default_domain() noexcept
+	{
+		// Never destroyed: objects may be retired from static destructors.
+		static hazard_pointer_domain* domain = new hazard_pointer_domain();
+		return *domain;
+	}
+
+	inline hazard_pointer make_hazard_pointer(hazard_pointer_domain& domain = hazard_pointer_default_domain())
+	{
+		return domain.make_hazard_pointer();
+	}
+
+	// Base for nodes of lock-free structures: retire() stores the deleter in
+	// the node and reclaims it through the domain.
+	template <typename T, typename Deleter = default_delete<T>>
+	class hazard_pointer_obj_base
+	{
+	public:
+		void retire(Deleter deleter = Deleter(), hazard_pointer_domain& domain = hazard_pointer_default_domain())
+		{
+			m_Deleter = std::move(deleter);
+			domain.retire(static_cast<T*>(this), &Reclaim);
+		}
+
+	protected:
+		hazard_pointer_obj_base() = default;
+		hazard_pointer_obj_base(const hazard_pointer_obj_base&) = default;
+		hazard_pointer_obj_base& operator=(const hazard_pointer_obj_base&) = default;
+		~hazard_pointer_obj_base() = default;
+
+	private:
+		static void Reclaim(void* ptr)
+		{
+			T* object = static_cast<T*>(ptr);
+			Deleter deleter = std::move(object->hazard_pointer_obj_base::m_Deleter);
+			deleter(object);
+		}
+
+	private:
+		MTL_NO_UNIQUE_ADDRESS Deleter m_Deleter;
+	};
+}
@@ -0,0 +1,363 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include "Vector.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <sys/mman.h>
+#endif
+
+namespace mtl
+{
+	enum class huge_page_kind
+	{
+		// Explicitly reserved huge pages: MAP_HUGETLB or MEM_LARGE_PAGES.
+		explicit_pages,
+		// 2 MiB-aligned mapping advised with MADV_HUGEPAGE; the kernel backs it
+		// with huge pages when it can, which huge_pages_obtained() measures.
+		transparent,
+		// Plain pages.
+		none
+	};
+
+	struct huge_page_options
+	{
+		bool allow_explicit = true;
+		bool allow_transparent = true;
+	};
+
+	struct huge_page_stats
+	{
+		size_t chunks_mapped;
+		size_t bytes_mapped;
+		size_t explicit_chunks;
+		size_t transparent_chunks;
+		size_t fallback_chunks;
+	};
+
+	namespace detail
+	{
+		struct huge_mapping
+		{
+			std::byte* ptr;
+			size_t bytes;
+			huge_page_kind kind;
+		};
+
+		inline constexpr size_t HUGE_PAGE_SIZE{ 2 * 1024 * 1024 };
+		// Alignment every mapping is guaranteed to have. Plain VirtualAlloc
+		// only aligns to the 64 KiB allocation granularity.
+#if defined(_WIN32)
+		inline constexpr size_t MAPPING_ALIGNMENT{ 64 * 1024 };
+#else
+		inline constexpr size_t MAPPING_ALIGNMENT{ HUGE_PAGE_SIZE };
+#endif
+
+		inline constexpr size_t round_to_huge_page(size_t bytes) noexcept
+		{
+			return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+		}
+
+		// bytes must be a multiple of HUGE_PAGE_SIZE.
+		inline huge_mapping map_huge_pages(size_t bytes, huge_page_options options)
+		{
+#if defined(_WIN32)
+			if (options.allow_explicit)
+			{
+				// Needs SeLockMemoryPrivilege; fails cleanly without it.
+				if (size_t large = GetLargePageMinimum(); large != 0 && HUGE_PAGE_SIZE % large == 0)
+				{
+					if (void* ptr = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE))
+						return { static_cast<std::byte*>(ptr), bytes, huge_page_kind::explicit_pages };
+				}
+			}
+			void* ptr = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (!ptr)
+				throw std::bad_alloc();
+			return { static_cast<std::byte*>(ptr), bytes, huge_page_kind::none };
+#elif defined(__linux__)
+			constexpr int FLAGS = MAP_PRIVATE | MAP_ANONYMOUS;
+			if (options.allow_explicit)
+			{
+				// Fails unless huge pages have been reserved in vm.nr_hugepages.
+				void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, FLAGS | MAP_HUGETLB, -1, 0);
+				if (ptr != MAP_FAILED)
+					return { static_cast<std::byte*>(ptr), bytes, huge_page_kind::explicit_pages };
+			}
+
+			// Over-reserve so the mapping can be trimmed to a huge page boundary;
+			// the kernel only backs aligned 2 MiB ranges with transparent pages.
+			size_t reserved = bytes + HUGE_PAGE_SIZE;
+			void* raw = mmap(nullptr, reserved, PROT_READ | PROT_WRITE, FLAGS, -1, 0);
+			if (raw == MAP_FAILED)
+				throw std::bad_alloc();
+
+			std::byte* begin = static_cast<std::byte*>(raw);
+			std::byte* aligned = begin + (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(begin) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+			if (aligned != begin)
+				munmap(begin, aligned - begin);
+			if (std::byte* tail = aligned + bytes; tail != begin + reserved)
+				munmap(tail, begin + reserved - tail);
+
+			if (options.allow_transparent && madvise(aligned, bytes, MADV_HUGEPAGE) == 0)
+				return { aligned, bytes, huge_page_kind::transparent };
+			return { aligned, bytes, huge_page_kind::none };
+#else
+			(void)options;
+			void* ptr = ::operator new(bytes, std::align_val_t{ HUGE_PAGE_SIZE });
+			return { static_cast<std::byte*>(ptr), bytes, huge_page_kind::none };
+#endif
+		}
+
+		inline void unmap_huge_pages(const huge_mapping& mapping) noexcept
+		{
+#if defined(_WIN32)
+			VirtualFree(mapping.ptr, 0, MEM_RELEASE);
+#elif defined(__linux__)
+			munmap(mapping.ptr, mapping.bytes);
+#else
+			::operator delete(mapping.ptr, std::align_val_t{ HUGE_PAGE_SIZE });
+#endif
+		}
+
+		// Sums AnonHugePages over the smaps entries that overlap the given
+		// mappings. Returns 0 where the information is unavailable.
+		inline size_t count_transparent_huge_pages(const mtl::vector<huge_mapping>& mappings)
+		{
+#if defined(__linux__)
+			FILE* smaps = std::fopen("/proc/self/smaps", "r");
+			if (!smaps)
+				return 0;
+
+			size_t limit = 0;
+			for (const huge_mapping& mapping : mappings)
+			{
+				if (mapping.kind == huge_page_kind::transparent)
+					limit += mapping.bytes / HUGE_PAGE_SIZE;
+			}
+
+			size_t kilobytes = 0;
+			bool tracked = false;
+			char line[512];
+			while (std::fgets(line, sizeof(line), smaps))
+			{
+				unsigned long long begin, end;
+				if (std::sscanf(line, "%llx-%llx ", &begin, &end) == 2)
+				{
+					tracked = std::any_of(mappings.begin(), mappings.end(), [&](const huge_mapping& mapping)
+					{
+						uintptr_t start = reinterpret_cast<uintptr_t>(mapping.ptr);
+						return mapping.kind == huge_page_kind::transparent && start < end && begin < start + mapping.bytes;
+					});
+					continue;
+				}
+
+				size_t size;
+				if (tracked && std::sscanf(line, "AnonHugePages: %zu kB", &size) == 1)
+					kilobytes += size;
+			}
+			std::fclose(smaps);
+			// The kernel may merge a mapping with its neighbours into one entry.
+			return std::min(kilobytes * 1024 / HUGE_PAGE_SIZE, limit);
+#else
+			(void)mappings;
+			return 0;
+#endif
+		}
+	}
+
+	// Arena over 2 MiB huge-page chunks for large containers, where TLB misses
+	// dominate traversal. Requests of at least half a chunk get a mapping of
+	// their own, returned to the system on deallocate, so a growing vector
+	// does not strand its old buffers. Smaller requests are bump-allocated
+	// from a shared chunk and only released with the arena.
+	class huge_page_arena
+	{
+	public:
+		static constexpr size_t HUGE_PAGE_SIZE{ detail::HUGE_PAGE_SIZE };
+		// Largest alignment allocate() can honour; larger requests throw.
+		static constexpr size_t MAX_ALIGNMENT{ detail::MAPPING_ALIGNMENT };
+
+		explicit huge_page_arena(huge_page_options options = {}) noexcept
+			: m_Options(options)
+		{
+		}
+		huge_page_arena(const huge_page_arena&) = delete;
+		huge_page_arena& operator=(const huge_page_arena&) = delete;
+		~huge_page_arena()
+		{
+			release();
+		}
+
+		void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+		{
+			if (alignment > MAX_ALIGNMENT)
+				throw std::bad_alloc();
+
+			std::lock_guard lock{ m_Mutex };
+			if (bytes >= HUGE_PAGE_SIZE / 2)
+				return Map(detail::round_to_huge_page(std::max<size_t>(bytes, 1))).ptr;
+
+			size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+			if (!m_Chunk || offset + bytes > HUGE_PAGE_SIZE)
+			{
+				m_Chunk = Map(HUGE_PAGE_SIZE).ptr;
+				offset = 0;
+			}
+			m_Offset = offset + bytes;
+			return m_Chunk + offset;
+		}
+		void deallocate(void* ptr, size_t bytes, size_t alignment = alignof(std::max_align_t)) noexcept
+		{
+			(void)alignment;
+			if (!ptr || bytes < HUGE_PAGE_SIZE / 2)
+				return;
+
+			std::lock_guard lock{ m_Mutex };
+			auto it = std::find_if(m_Mappings.begin(), m_Mappings.end(), [ptr](const detail::huge_mapping& mapping)
+			{
+				return mapping.ptr == ptr;
+			});
+			if (it == m_Mappings.end())
+				return;
+
+			detail::unmap_huge_pages(*it);
+			*it = m_Mappings[m_Mappings.size() - 1];
+			m_Mappings.pop_back();
+		}
+
+		// Unmaps every chunk, including those still in use.
+		void release() noexcept
+		{
+			std::lock_guard lock{ m_Mutex };
+			for (const detail::huge_mapping& mapping : m_Mappings)
+				detail::unmap_huge_pages(mapping);
+			m_Mappings.clear();
+			m_Chunk = nullptr;
+			m_Offset = 0;
+		}
+
+		// Huge pages currently backing the arena: every page of an explicit
+		// mapping plus the transparent pages the kernel actually granted.
+		size_t huge_pages_obtained() const
+		{
+			std::lock_guard lock{ m_Mutex };
+			size_t pages = 0;
+			for (const detail::huge_mapping& mapping : m_Mappings)
+			{
+				if (mapping.kind == huge_page_kind::explicit_pages)
+					pages += mapping.bytes / HUGE_PAGE_SIZE;
+			}
+			return pages + detail::count_transparent_huge_pages(m_Mappings);
+		}
+
+		huge_page_stats stats() const noexcept
+		{
+			std::lock_guard lock{ m_Mutex };
+			return m_Stats;
+		}
+		huge_page_options options() const noexcept
+		{
+			return m_Options;
+		}
+
+	private:
+		detail::huge_mapping Map(size_t bytes)
+		{
+			detail::huge_mapping mapping = detail::map_huge_pages(bytes, m_Options);
+			try
+			{
+				m_Mappings.push_back(mapping);
+			}
+			catch (...)
+			{
+				detail::unmap_huge_pages(mapping);
+				throw;
+			}
+
+			++m_Stats.chunks_mapped;
+			m_Stats.bytes_mapped += bytes;
+			switch (mapping.kind)
+			{
+			case huge_page_kind::explicit_pages: ++m_Stats.explicit_chunks; break;
+			case huge_page_kind::transparent: ++m_Stats.transparent_chunks; break;
+			case huge_page_kind::none: ++m_Stats.fallback_chunks; break;
+			}
+			return mapping;
+		}
+
+		mutable std::mutex m_Mutex;
+		huge_page_options m_Options;
+		mtl::vector<detail::huge_mapping> m_Mappings;
+		std::byte* m_Chunk{};
+		size_t m_Offset{};
+		huge_page_stats m_Stats{};
+	};
+
+	// Never destroyed: containers with static storage duration may still
+	// release into it during static destructors.
+	inline huge_page_arena& default_huge_page_arena()
+	{
+		static huge_page_arena* arena = new huge_page_arena();
+		return *arena;
+	}
+
+	template <typename T>
+	class huge_page_allocator
+	{
+	public:
+		using value_type = T;
+
+		huge_page_allocator() noexcept
+			: m_Arena(&default_huge_page_arena())
+		{
+		}
+		huge_page_allocator(huge_page_arena& arena) noexcept
+			: m_Arena(&arena)
+		{
+		}
+		template <typename U>
+		huge_page_allocator(const huge_page_allocator<U>& other) noexcept
+			: m_Arena(&other.arena())
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(T))
+				throw std::bad_array_new_length();
+
+			return static_cast<T*>(m_Arena->allocate(count * sizeof(T), alignof(T)));
+		}
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			m_Arena->deallocate(ptr, count * sizeof(T), alignof(T));
+		}
+
+		huge_page_arena& arena() const noexcept
+		{
+			return *m_Arena;
+		}
+
+	private:
+		huge_page_arena* m_Arena;
+	};
+
+	template <typename T, typename U>
+	bool operator==(const huge_page_allocator<T>& lhs, const huge_page_allocator<U>& rhs) noexcept
+	{
+		return &lhs.arena() == &rhs.arena();
+	}
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include "Memory.hpp"
+#include <type_traits>
+
+namespace mtl
+{
+	template <typename T>
+	class intrusive_ptr;
+
+	// Embeds a single reference count in the object, so intrusive_ptr is one
+	// pointer and the object carries nothing else: no vtable, no weak count.
+	// The last release deletes the object as a Derived, so classes deriving
+	// further from Derived need a virtual destructor. Objects that must also
+	// be reachable from shared_ptr and weak_ptr use shared_ref_counted.
+	//
+	// The count starts at zero and the first intrusive_ptr may be taken on
+	// any thread. biased_ref_count ties the count to the constructing thread
+	// and never frees the object if another thread takes the first
+	// reference, so only atomic_ref_count and local_ref_count are accepted.
+	template <typename Derived, typename Policy = atomic_ref_count>
+		requires (std::is_same_v<Policy, atomic_ref_count> || std::is_same_v<Policy, local_ref_count>)
+	class ref_counted
+	{
+		template <typename U>
+		friend class intrusive_ptr;
+
+	public:
+		using ref_count_policy = Policy;
+
+		size_t use_count() const noexcept
+		{
+			return m_RefCount.load();
+		}
+
+	protected:
+		ref_counted() noexcept = default;
+		ref_counted(const ref_counted&) noexcept
+			: ref_counted()
+		{
+		}
+		ref_counted& operator=(const ref_counted&) noexcept
+		{
+			return *this;
+		}
+		~ref_counted() = default;
+
+	private:
+		using ref_counted_type = ref_counted;
+
+		static void Delete(ref_counted* object)
+		{
+			delete static_cast<Derived*>(object);
+		}
+		static void Acquire(ref_counted* object) noexcept
+		{
+			object->m_RefCount.increment();
+		}
+		static void Release(ref_counted* object)
+		{
+			if (object->m_RefCount.decrement())
+				Delete(object);
+		}
+
+	private:
+		Policy m_RefCount{ 0 };
+	};
+
+	// ref_counted that doubles as a shared_ptr control block, so to_shared()
+	// hands out shared_ptrs and weak_ptrs that share the object's count. It
+	// costs a vtable pointer and a weak count on top of the strong count. The
+	// object is destroyed once the strong count and every weak_ptr are gone.
+	// The policy is restricted as for ref_counted.
+	template <typename Derived, typename Policy = atomic_ref_count>
+		requires (std::is_same_v<Policy, atomic_ref_count> || std::is_same_v<Policy, local_ref_count>)
+	class shared_ref_counted : private detail::control_block_base<Policy>
+	{
+		template <typename U>
+		friend class intrusive_ptr;
+		template <typename U>
+		friend shared_ptr<U, typename U::ref_count_policy> to_shared(const intrusive_ptr<U>& ptr);
+
+	public:
+		using ref_count_policy = Policy;
+
+		size_t use_count() const noexcept
+		{
+			return this->RefCount();
+		}
+
+	protected:
+		shared_ref_counted() noexcept
+			: detail::control_block_base<Policy>(0)
+		{
+		}
+		shared_ref_counted(const shared_ref_counted&) noexcept
+			: shared_ref_counted()
+		{
+		}
+		shared_ref_counted& operator=(const shared_ref_counted&) noexcept
+		{
+			return *this;
+		}
+		~shared_ref_counted() override = default;
+
+	private:
+		using ref_counted_type = shared_ref_counted;
+
+		// Final, so a Derived member with the same name is a compile error
+		// rather than a silent override.
+		void Destroy() final
+		{
+		}
+		void DeleteThis() final
+		{
+			delete this;
+		}
+		static detail::control_block_base<Policy>* ControlBlock(shared_ref_counted* object) noexcept
+		{
+			return object;
+		}
+		static void Acquire(shared_ref_counted* object) noexcept
+		{
+			object->IncRef();
+		}
+		static void Release(shared_ref_counted* object)
+		{
+			object->DecRef();
+		}
+	};
+
+	template <typename T>
+	class intrusive_ptr
+	{
+		template <typename U>
+		friend class intrusive_ptr;
+
+		using ref_counted_type = typename T::ref_counted_type;
+
+	public:
+		intrusive_ptr() = default;
+		explicit intrusive_ptr(T* data)
+			: m_Data(data)
+		{
+			IncRef();
+		}
+		~intrusive_ptr()
+		{
+			DecRef();
+		}
+		intrusive_ptr(const intrusive_ptr& rhs)
+			: m_Data(rhs.m_Data)
+		{
+			IncRef();
+		}
+		template <typename U>
+			requires std::is_convertible_v<U*, T*>
+		intrusive_ptr(const intrusive_ptr<U>& rhs)
+			: m_Data(rhs.m_Data)
+		{
+			IncRef();
+		}
+		intrusive_ptr(intrusive_ptr&& rhs) noexcept
+			: m_Data(std::exchange(rhs.m_Data, nullptr))
+		{
+		}
+		intrusive_ptr& operator=(intrusive_ptr rhs) noexcept
+		{
+			swap(*this, rhs);
+			return *this;
+		}
+
+		T& operator*() const
+		{
+			return *m_Data;
+		}
+		T* operator->() const
+		{
+			return m_Data;
+		}
+		T* get() const noexcept
+		{
+			return m_Data;
+		}
+		void reset() noexcept
+		{
+			intrusive_ptr tmp;
+			swap(*this, tmp);
+		}
+		explicit operator bool() const
+		{
+			return m_Data != nullptr;
+		}
+
+		friend bool operator==(const intrusive_ptr& lhs, const intrusive_ptr& rhs)
+		{
+			return lhs.m_Data == rhs.m_Data;
+		}
+
+	private:
+		friend void swap(intrusive_ptr& lhs, intrusive_ptr& rhs) noexcept
+		{
+			std::swap(lhs.m_Data, rhs.m_Data);
+		}
+		void IncRef()
+		{
+			if (m_Data)
+				ref_counted_type::Acquire(m_Data);
+		}
+		void DecRef()
+		{
+			if (m_Data)
+				ref_counted_type::Release(m_Data);
+		}
+
+	private:
+		T* m_Data{ nullptr };
+	};
+
+	template <typename T, typename... Args>
+	intrusive_ptr<T> make_intrusive(Args&&... args)
+	{
+		return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+	}
+
+	// Only for shared_ref_counted types.
+	template <typename T>
+	shared_ptr<T, typename T::ref_count_policy> to_shared(const intrusive_ptr<T>& ptr)
+	{
+		if (!ptr)
+			return shared_ptr<T, typename T::ref_count_policy>();
+
+		return detail::shared_access::Share(ptr.get(), T::ref_counted_type::ControlBlock(ptr.get()));
+	}
+}
@@ -1,31 +1,57 @@
+#pragma once
 #include "Memory.hpp"
 #include <iterator>
+#include <stdexcept>
 
 namespace mtl
 {
 	template <typename T>
+	class polymorphic_allocator;
+
+	template <typename T, typename Alloc = std::allocator<T>>
 	class list
 	{
 		struct node_base;
 		struct node;
 		class iterator;
 
+		using node_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+		using alloc_traits = std::allocator_traits<node_alloc>;
+		// Links use the allocator's pointer type, so a list can live in shared
+		// memory with offset_ptr links; the code below works on raw pointers.
+		// Taken from Alloc, as node_alloc's traits need the complete node.
+		using element_pointer = typename std::allocator_traits<Alloc>::pointer;
+		using node_pointer = typename std::pointer_traits<element_pointer>::template rebind<node>;
+		using base_pointer = typename std::pointer_traits<element_pointer>::template rebind<node_base>;
+
 	public:
+		using allocator_type = Alloc;
+
 		list() = default;
 		~list()
 		{
 			clear();
 		}
+		explicit list(const Alloc& alloc)
+			: m_Allocator(alloc)
+		{
+		}
 		list(const list& rhs)
+			: list(rhs, std::allocator_traits<Alloc>::select_on_container_copy_construction(rhs.get_allocator()))
 		{
-			node_base* it = rhs.m_Sentinel.next;
+		}
+		list(const list& rhs, const Alloc& alloc)
+			: m_Allocator(alloc)
+		{
+			const node_base* it = std::to_address(rhs.m_Sentinel.next);
 			while (it != &rhs.m_Sentinel)
 			{
-				push_back(static_cast<node*>(it)->data);
-				it = it->next;
+				push_back(static_cast<const node*>(it)->data());
+				it = std::to_address(it->next);
 			}
 		}
-		list(std::initializer_list<T> rhs)
+		list(std::initializer_list<T> rhs, const Alloc& alloc = Alloc())
+			: m_Allocator(alloc)
 		{
 			for (const auto& item : rhs)
 			{
@@ -33,14 +59,52 @@ namespace mtl
 			}
 		}
 		list(list&& rhs) noexcept
+			: m_Allocator(rhs.m_Allocator)
 		{
-			swap(*this, rhs);
+			swap_contents(rhs);
 		}
-		list& operator=(list rhs) noexcept
+		list(list&& rhs, const Alloc& alloc)
+			: m_Allocator(alloc)
 		{
-			swap(*this, rhs);
+			if (m_Allocator == rhs.m_Allocator)
+			{
+				swap_contents(rhs);
+			}
+			else
+			{
+				for (auto& item : rhs)
+					push_back(std::move(item));
+			}
+		}
+		// Assignment keeps this list's allocator unless the allocator asks to
+		// propagate, so nodes are always freed into the resource they came from.
+		list& operator=(const list& rhs)
+		{
+			if (this != &rhs)
+			{
+				list tmp(rhs, alloc_traits::propagate_on_container_copy_assignment::value ? rhs.get_allocator() : get_allocator());
+				swap(*this, tmp);
+			}
 			return *this;
 		}
+		list& operator=(list&& rhs) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+		{
+			if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+			{
+				list tmp(std::move(rhs));
+				swap(*this, tmp);
+			}
+			else
+			{
+				list tmp(std::move(rhs), get_allocator());
+				swap(*this, tmp);
+			}
+			return *this;
+		}
+		allocator_type get_allocator() const noexcept
+		{
+			return allocator_type(m_Allocator);
+		}
 		void push_back(const T& value)
 		{
 			emplace(end(), value);
@@ -58,11 +122,11 @@ namespace mtl
 		{
 			if (m_Size != 0)
 			{
-				node_base* last = m_Sentinel.prev;
-				node_base* new_last = last->prev;
+				node_base* last = std::to_address(m_Sentinel.prev);
+				node_base* new_last = std::to_address(last->prev);
 				m_Sentinel.prev = new_last;
 				new_last->next = &m_Sentinel;
-				delete static_cast<node*>(last);
+				destroy_node(static_cast<node*>(last));
 				--m_Size;
 			}
 		}
@@ -83,11 +147,11 @@ namespace mtl
 		{
 			if (m_Size != 0)
 			{
-				node_base* first = m_Sentinel.next;
-				node_base* new_first = first->next;
+				node_base* first = std::to_address(m_Sentinel.next);
+				node_base* new_first = std::to_address(first->next);
 				m_Sentinel.next = new_first;
 				new_first->prev = &m_Sentinel;
-				delete static_cast<node*>(first);
+				destroy_node(static_cast<node*>(first));
 				--m_Size;
 			}
 		}
@@ -98,12 +162,12 @@ namespace mtl
 		iterator erase(iterator pos)
 		{
 			node_base* cur = pos.m_Node;
-			node_base* next_node = cur->next;
-			node_base* prev_node = cur->prev;
+			node_base* next_node = std::to_address(cur->next);
+			node_base* prev_node = std::to_address(cur->prev);
 
 			next_node->prev = prev_node;
 			prev_node->next = next_node;
-			delete static_cast<node*>(cur);
+			destroy_node(static_cast<node*>(cur));
 			--m_Size;
 
 			return iterator(next_node);
@@ -113,14 +177,14 @@ namespace mtl
 			if (empty())
 				throw std::runtime_error("List is empty");
 
-			return static_cast<node*>(m_Sentinel.prev)->data;
+			return static_cast<node*>(std::to_address(m_Sentinel.prev))->data();
 		}
 		const T& front() const
 		{
 			if (empty())
 				throw std::runtime_error("List is empty");
 
-			return static_cast<node*>(m_Sentinel.next)->data;
+			return static_cast<node*>(std::to_address(m_Sentinel.next))->data();
 		}
 		iterator end()
 		{
@@ -128,16 +192,16 @@ namespace mtl
 		}
 		iterator begin()
 		{
-			return iterator(m_Sentinel.next);
+			return iterator(std::to_address(m_Sentinel.next));
 		}
 		void clear()
 		{
-			node_base* it = m_Sentinel.next;
+			node_base* it = std::to_address(m_Sentinel.next);
 			while (it != &m_Sentinel)
 			{
 				node* temp = static_cast<node*>(it);
-				it = it->next;
-				delete temp;
+				it = std::to_address(it->next);
+				destroy_node(temp);
 			}
 			m_Size = 0;
 			fix_sentinel();
@@ -153,21 +217,22 @@ namespace mtl
 	private:
 		struct node_base
 		{
-			node_base* prev{ this };
-			node_base* next{ this };
+			base_pointer prev{ this };
+			base_pointer next{ this };
 		};
+		// The element is built separately through the allocator, so that
+		// allocator-aware elements receive it.
 		struct node : public node_base
 		{
-			T data;
+			alignas(T) std::byte storage[sizeof(T)];
 
-			node(const T& value)
-				: data(value)
+			T& data()
 			{
+				return *std::launder(reinterpret_cast<T*>(storage));
 			}
-			template <typename... Args>
-			node(Args&&... args)
-				: data(std::forward<Args>(args)...)
+			const T& data() const
 			{
+				return *std::launder(reinterpret_cast<const T*>(storage));
 			}
 		};
 		class iterator
@@ -186,15 +251,15 @@ namespace mtl
 			}
 			reference operator*() const
 			{
-				return static_cast<node*>(m_Node)->data;
+				return static_cast<node*>(m_Node)->data();
 			}
 			pointer operator->() const
 			{
-				return &static_cast<node*>(m_Node)->data;
+				return &static_cast<node*>(m_Node)->data();
 			}
 			iterator& operator++()
 			{
-				m_Node = m_Node->next;
+				m_Node = std::to_address(m_Node->next);
 				return *this;
 			}
 			iterator operator++(int)
@@ -205,7 +270,7 @@ namespace mtl
 			}
 			iterator& operator--()
 			{
-				m_Node = m_Node->prev;
+				m_Node = std::to_address(m_Node->prev);
 				return *this;
 			}
 			iterator operator--(int)
@@ -229,10 +294,10 @@ namespace mtl
 		template <typename... Args>
 		iterator emplace(iterator pos, Args&&... args)
 		{
-			node* new_node = new node(std::forward<Args>(args)...);
+			node* new_node = create_node(std::forward<Args>(args)...);
 
 			node_base* next_node = pos.m_Node;
-			node_base* prev_node = next_node->prev;
+			node_base* prev_node = std::to_address(next_node->prev);
 
 			new_node->next = next_node;
 			new_node->prev = prev_node;
@@ -252,17 +317,50 @@ namespace mtl
 			else
 				m_Sentinel.next = m_Sentinel.prev = &m_Sentinel;
 		}
-		friend void swap(list& lhs, list& rhs)
+		template <typename... Args>
+		node* create_node(Args&&... args)
+		{
+			node_pointer allocated = alloc_traits::allocate(m_Allocator, 1);
+			node* new_node = ::new (static_cast<void*>(std::to_address(allocated))) node;
+			try
+			{
+				alloc_traits::construct(m_Allocator, &new_node->data(), std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				alloc_traits::deallocate(m_Allocator, allocated, 1);
+				throw;
+			}
+			return new_node;
+		}
+		void destroy_node(node* old_node)
 		{
-			std::swap(lhs.m_Size, rhs.m_Size);
-			std::swap(lhs.m_Sentinel.next, rhs.m_Sentinel.next);
-			std::swap(lhs.m_Sentinel.prev, rhs.m_Sentinel.prev);
-			lhs.fix_sentinel();
+			alloc_traits::destroy(m_Allocator, &old_node->data());
+			alloc_traits::deallocate(m_Allocator, std::pointer_traits<node_pointer>::pointer_to(*old_node), 1);
+		}
+		void swap_contents(list& rhs) noexcept
+		{
+			std::swap(m_Size, rhs.m_Size);
+			std::swap(m_Sentinel.next, rhs.m_Sentinel.next);
+			std::swap(m_Sentinel.prev, rhs.m_Sentinel.prev);
+			fix_sentinel();
 			rhs.fix_sentinel();
 		}
-		
+		friend void swap(list& lhs, list& rhs) noexcept
+		{
+			lhs.swap_contents(rhs);
+			std::swap(lhs.m_Allocator, rhs.m_Allocator);
+		}
+
 	private:
 		node_base m_Sentinel;
 		size_t m_Size{ 0 };
+		MTL_NO_UNIQUE_ADDRESS node_alloc m_Allocator;
 	};
+
+	namespace pmr
+	{
+		template <typename T>
+		using list = mtl::list<T, polymorphic_allocator<T>>;
+	}
 }
\ No newline at end of file
@@ -1,27 +1,73 @@
 #pragma once
 #include <utility>
 #include <atomic>
+#include <cstdint>
 #include <new>
+#include <exception>
+#include <type_traits>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include "BlockPool.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MTL_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define MTL_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
 
 namespace mtl
 {
 	template <typename T>
+	struct default_delete
+	{
+		default_delete() = default;
+		template <typename U>
+			requires std::is_convertible_v<U*, T*>
+		default_delete(const default_delete<U>&) noexcept
+		{
+		}
+		void operator()(T* data) const
+		{
+			delete data;
+		}
+	};
+
+	template <typename T>
+	struct default_delete<T[]>
+	{
+		void operator()(T* data) const
+		{
+			delete[] data;
+		}
+	};
+
+	template <typename T, typename Deleter = default_delete<T>>
 	class unique_ptr
 	{
 	public:
 		unique_ptr() = default;
 		~unique_ptr()
 		{
-			delete m_Data;
+			if (m_Data)
+				m_Deleter(m_Data);
 		}
 		explicit unique_ptr(T* data)
 			: m_Data(data)
 		{
 		}
+		unique_ptr(T* data, const Deleter& deleter)
+			: m_Data(data), m_Deleter(deleter)
+		{
+		}
+		unique_ptr(T* data, Deleter&& deleter)
+			: m_Data(data), m_Deleter(std::move(deleter))
+		{
+		}
 		unique_ptr(const unique_ptr& rhs) = delete;
 		unique_ptr(unique_ptr&& rhs) noexcept
+			: m_Data(rhs.release()), m_Deleter(std::move(rhs.m_Deleter))
 		{
-			swap(*this, rhs);
 		}
 		unique_ptr& operator=(const unique_ptr& rhs) = delete;
 		unique_ptr& operator=(unique_ptr&& rhs) noexcept
@@ -46,10 +92,18 @@ namespace mtl
 		{
 			return m_Data;
 		}
-		void reset(T* data)
+		Deleter& get_deleter() noexcept
+		{
+			return m_Deleter;
+		}
+		const Deleter& get_deleter() const noexcept
 		{
-			delete m_Data;
-			m_Data = data;
+			return m_Deleter;
+		}
+		void reset(T* data = nullptr)
+		{
+			if (T* old = std::exchange(m_Data, data))
+				m_Deleter(old);
 		}
 
 		explicit operator bool() const
@@ -61,28 +115,39 @@ namespace mtl
 		friend void swap(unique_ptr& lhs, unique_ptr& rhs) noexcept
 		{
 			std::swap(lhs.m_Data, rhs.m_Data);
+			std::swap(lhs.m_Deleter, rhs.m_Deleter);
 		}
 	private:
 		T* m_Data{ nullptr };
+		MTL_NO_UNIQUE_ADDRESS Deleter m_Deleter;
 	};
 
-	template <typename T>
-	class unique_ptr<T[]>
+	template <typename T, typename Deleter>
+	class unique_ptr<T[], Deleter>
 	{
 	public:
 		unique_ptr() = default;
 		~unique_ptr()
 		{
-			delete[] m_Data;
+			if (m_Data)
+				m_Deleter(m_Data);
 		}
 		unique_ptr(T* data)
 			: m_Data(data)
 		{
 		}
+		unique_ptr(T* data, const Deleter& deleter)
+			: m_Data(data), m_Deleter(deleter)
+		{
+		}
+		unique_ptr(T* data, Deleter&& deleter)
+			: m_Data(data), m_Deleter(std::move(deleter))
+		{
+		}
 		unique_ptr(const unique_ptr& rhs) = delete;
 		unique_ptr(unique_ptr&& rhs) noexcept
+			: m_Data(rhs.release()), m_Deleter(std::move(rhs.m_Deleter))
 		{
-			swap(*this, rhs);
 		}
 		unique_ptr& operator=(const unique_ptr& rhs) = delete;
 		unique_ptr& operator=(unique_ptr&& rhs) noexcept
@@ -103,10 +168,18 @@ namespace mtl
 		{
 			return m_Data;
 		}
-		void reset(T* data)
+		Deleter& get_deleter() noexcept
+		{
+			return m_Deleter;
+		}
+		const Deleter& get_deleter() const noexcept
 		{
-			delete[] m_Data;
-			m_Data = data;
+			return m_Deleter;
+		}
+		void reset(T* data = nullptr)
+		{
+			if (T* old = std::exchange(m_Data, data))
+				m_Deleter(old);
 		}
 
 		explicit operator bool() const
@@ -118,159 +191,569 @@ namespace mtl
 		friend void swap(unique_ptr& lhs, unique_ptr& rhs) noexcept
 		{
 			std::swap(lhs.m_Data, rhs.m_Data);
+			std::swap(lhs.m_Deleter, rhs.m_Deleter);
 		}
 
 	private:
 		T* m_Data{ nullptr };
+		MTL_NO_UNIQUE_ADDRESS Deleter m_Deleter;
 	};
 
 	template <typename T>
 	concept non_array = !std::is_array_v<T>;
-
 	template <typename T>
-	class shared_ptr
-	{
-		template <non_array T, typename... Args>
-		friend shared_ptr<T> make_shared(Args&&... args);
+	concept unbounded_array = std::is_unbounded_array_v<T>;
+	template <typename T>
+	concept bounded_array = std::is_bounded_array_v<T>;
 
+	class bad_weak_ptr : public std::exception
+	{
 	public:
-		shared_ptr() = default;
-		explicit shared_ptr(T* data)
-			: m_Data(data), m_ControlBlock(new control_block(data))
+		const char* what() const noexcept override
 		{
+			return "mtl::bad_weak_ptr";
 		}
-		~shared_ptr()
-		{
-			DecRef();
-		}
-		shared_ptr(const shared_ptr& rhs)
-			: m_Data(rhs.m_Data), m_ControlBlock(rhs.m_ControlBlock)
+	};
+
+	class atomic_ref_count
+	{
+	public:
+		explicit atomic_ref_count(size_t count) noexcept
+			: m_Count(count)
 		{
-			IncRef();
 		}
-		shared_ptr(shared_ptr&& rhs) noexcept
+		void increment() noexcept
 		{
-			swap(*this, rhs);
+			m_Count.fetch_add(1, std::memory_order_relaxed);
 		}
-		shared_ptr& operator=(const shared_ptr& rhs)
+		bool try_increment() noexcept
 		{
-			if (this != &rhs)
+			size_t count = m_Count.load(std::memory_order_relaxed);
+			while (count != 0)
 			{
-				DecRef();
-				m_Data = rhs.m_Data;
-				m_ControlBlock = rhs.m_ControlBlock;
-				IncRef();
+				if (m_Count.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+					return true;
 			}
-			return *this;
+			return false;
 		}
-		shared_ptr& operator=(shared_ptr&& rhs)
+		bool decrement() noexcept
 		{
-			shared_ptr temp(std::move(rhs));
-			swap(*this, temp);
-			return *this;
+			return m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		}
+		size_t load() const noexcept
+		{
+			return m_Count.load(std::memory_order_relaxed);
 		}
 
-		T& operator*() const 
-		{ 
-			return *m_Data; 
+	private:
+		std::atomic<size_t> m_Count;
+	};
+
+	// Plain counts for object graphs that never leave the creating thread.
+	class local_ref_count
+	{
+	public:
+		explicit local_ref_count(size_t count) noexcept
+			: m_Count(count)
+		{
 		}
-		T* operator->() const 
-		{ 
-			return m_Data;
+		void increment() noexcept
+		{
+			++m_Count;
 		}
-		T* get() const noexcept
-		{ 
-			return m_Data;
+		bool try_increment() noexcept
+		{
+			if (m_Count == 0)
+				return false;
+
+			++m_Count;
+			return true;
 		}
-		size_t use_count() const noexcept
+		bool decrement() noexcept
 		{
-			return m_ControlBlock ? m_ControlBlock->RefCount() : 0;
+			return --m_Count == 0;
 		}
-		explicit operator bool() const 
+		size_t load() const noexcept
 		{
-			return m_Data != nullptr;
+			return m_Count;
 		}
 
 	private:
+		size_t m_Count;
+	};
+
+	template <typename T, typename Policy = atomic_ref_count>
+	class shared_ptr;
+	template <typename T, typename Policy = atomic_ref_count>
+	class weak_ptr;
+	template <typename T, typename Policy = atomic_ref_count>
+	class enable_shared_from_this;
+
+	template <typename T>
+	using local_shared_ptr = shared_ptr<T, local_ref_count>;
+	template <typename T>
+	using local_weak_ptr = weak_ptr<T, local_ref_count>;
+
+	namespace detail
+	{
+		template <typename Policy>
 		class control_block_base
 		{
-			friend class shared_ptr;
-
 		public:
 			virtual ~control_block_base() = default;
 			void IncRef()
 			{
-				m_RefCount++;
+				m_RefCount.increment();
+			}
+			bool TryIncRef()
+			{
+				return m_RefCount.try_increment();
 			}
 			void DecRef()
 			{
-				if (--m_RefCount == 0)
+				if (m_RefCount.decrement())
 				{
 					Destroy();
+					DecWeakRef();
+				}
+			}
+			void IncWeakRef()
+			{
+				m_WeakCount.increment();
+			}
+			void DecWeakRef()
+			{
+				if (m_WeakCount.decrement())
+				{
 					DeleteThis();
 				}
 			}
 			size_t RefCount() const
 			{
-				return m_RefCount;
+				return m_RefCount.load();
 			}
 			virtual void DeleteThis() = 0;
 			virtual void Destroy() = 0;
 
+		protected:
+			control_block_base()
+			{
+				BindCounts();
+			}
+			explicit control_block_base(size_t ref_count)
+				: m_RefCount(ref_count)
+			{
+				BindCounts();
+			}
+
+		private:
+			// Policies that can observe a count reaching zero outside of
+			// decrement() (see biased_ref_count) report it through these.
+			void BindCounts()
+			{
+				if constexpr (requires (Policy& count) { count.bind(this, &ReleaseStrong); })
+				{
+					m_RefCount.bind(this, &ReleaseStrong);
+					m_WeakCount.bind(this, &ReleaseWeak);
+				}
+			}
+			static void ReleaseStrong(void* block)
+			{
+				auto self = static_cast<control_block_base*>(block);
+				self->Destroy();
+				self->DecWeakRef();
+			}
+			static void ReleaseWeak(void* block)
+			{
+				static_cast<control_block_base*>(block)->DeleteThis();
+			}
+
 		private:
-			std::atomic<size_t> m_RefCount{ 1 };
+			Policy m_RefCount{ 1 };
+			// All strong references together hold a single weak reference,
+			// so the block outlives the object until the last weak_ptr is gone.
+			Policy m_WeakCount{ 1 };
 		};
 
-		class control_block : public control_block_base
+		template <typename T, typename Deleter, typename Policy>
+		class control_block : public control_block_base<Policy>
 		{
 		public:
-			control_block(T* data)
-				: m_Data(data)
+			control_block(T* data, Deleter deleter)
+				: m_Data(data), m_Deleter(std::move(deleter))
 			{
 			}
 			void Destroy() override
 			{
-				delete m_Data;
+				m_Deleter(m_Data);
 			}
 			void DeleteThis() override
 			{
 				delete this;
 			}
+			static void* operator new(size_t)
+			{
+				return block_pool<sizeof(control_block), alignof(control_block)>::allocate();
+			}
+			static void operator delete(void* ptr) noexcept
+			{
+				block_pool<sizeof(control_block), alignof(control_block)>::deallocate(ptr);
+			}
 
 		private:
 			T* m_Data;
+			MTL_NO_UNIQUE_ADDRESS Deleter m_Deleter;
 		};
 
-		class control_block_shared : public control_block_base
+		struct for_overwrite_t
 		{
-			friend class shared_ptr;
+		};
+
+		template <typename T, typename Alloc, typename Policy>
+		class control_block_shared : public control_block_base<Policy>
+		{
+			using alloc_traits = std::allocator_traits<Alloc>;
+			using block_alloc = typename alloc_traits::template rebind_alloc<control_block_shared>;
+			using block_traits = std::allocator_traits<block_alloc>;
 
 		public:
-			template<typename... Args>
-			control_block_shared(Args&&... args)
+			template <typename... Args>
+			static control_block_shared* Create(const Alloc& alloc, Args&&... args)
 			{
-				new(m_Data) T(std::forward<Args>(args)...);
+				block_alloc allocator(alloc);
+				auto block = std::to_address(block_traits::allocate(allocator, 1));
+				try
+				{
+					return new (block) control_block_shared(alloc, std::forward<Args>(args)...);
+				}
+				catch (...)
+				{
+					block_traits::deallocate(allocator, block, 1);
+					throw;
+				}
 			}
 			void Destroy() override
 			{
-				ObjPtr()->~T();
+				alloc_traits::destroy(m_Allocator, ObjPtr());
 			}
 			void DeleteThis() override
 			{
-				delete this;
+				block_alloc allocator(m_Allocator);
+				this->~control_block_shared();
+				block_traits::deallocate(allocator, this, 1);
 			}
 			T* ObjPtr()
 			{
 				return reinterpret_cast<T*>(&m_Data);
 			}
+
+		private:
+			template <typename... Args>
+			control_block_shared(const Alloc& alloc, Args&&... args)
+				: m_Allocator(alloc)
+			{
+				alloc_traits::construct(m_Allocator, ObjPtr(), std::forward<Args>(args)...);
+			}
+			control_block_shared(const Alloc& alloc, for_overwrite_t)
+				: m_Allocator(alloc)
+			{
+				::new (static_cast<void*>(ObjPtr())) T;
+			}
+
 		private:
+			MTL_NO_UNIQUE_ADDRESS Alloc m_Allocator;
 			alignas(T) std::byte m_Data[sizeof(T)];
 		};
 
-		shared_ptr(control_block_shared* block)
-			: m_Data(block->ObjPtr()), m_ControlBlock(block)
+		// Header and elements share one allocation: the elements start at the
+		// first suitably aligned offset past the block.
+		template <typename T, typename Alloc, typename Policy>
+		class control_block_shared_array : public control_block_base<Policy>
+		{
+			using alloc_traits = std::allocator_traits<Alloc>;
+			static constexpr size_t ALIGNMENT{ std::max({ alignof(T), alignof(control_block_base<Policy>), alignof(Alloc), alignof(size_t) }) };
+			struct alignas(ALIGNMENT) storage_unit
+			{
+				std::byte bytes[ALIGNMENT];
+			};
+			using unit_alloc = typename alloc_traits::template rebind_alloc<storage_unit>;
+			using unit_traits = std::allocator_traits<unit_alloc>;
+
+		public:
+			template <bool ForOverwrite>
+			static control_block_shared_array* Create(const Alloc& alloc, size_t size)
+			{
+				if (size > MaxSize())
+					throw std::bad_array_new_length();
+
+				unit_alloc allocator(alloc);
+				auto memory = std::to_address(unit_traits::allocate(allocator, UnitCount(size)));
+				auto block = new (memory) control_block_shared_array(alloc, size);
+
+				size_t constructed = 0;
+				try
+				{
+					if constexpr (ForOverwrite)
+					{
+						if constexpr (!std::is_trivially_default_constructible_v<T>)
+						{
+							for (; constructed < size; ++constructed)
+								::new (static_cast<void*>(block->ObjPtr() + constructed)) T;
+						}
+					}
+					else
+					{
+						for (; constructed < size; ++constructed)
+							alloc_traits::construct(block->m_Allocator, block->ObjPtr() + constructed);
+					}
+				}
+				catch (...)
+				{
+					block->DestroyElements(constructed);
+					block->~control_block_shared_array();
+					unit_traits::deallocate(allocator, memory, UnitCount(size));
+					throw;
+				}
+				return block;
+			}
+			void Destroy() override
+			{
+				DestroyElements(m_Size);
+			}
+			void DeleteThis() override
+			{
+				unit_alloc allocator(m_Allocator);
+				size_t units = UnitCount(m_Size);
+				this->~control_block_shared_array();
+				unit_traits::deallocate(allocator, reinterpret_cast<storage_unit*>(this), units);
+			}
+			T* ObjPtr()
+			{
+				return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(this) + ElementOffset());
+			}
+
+		private:
+			control_block_shared_array(const Alloc& alloc, size_t size)
+				: m_Allocator(alloc), m_Size(size)
+			{
+			}
+			void DestroyElements(size_t count)
+			{
+				if constexpr (!std::is_trivially_destructible_v<T>)
+				{
+					while (count > 0)
+						alloc_traits::destroy(m_Allocator, ObjPtr() + --count);
+				}
+			}
+			static constexpr size_t ElementOffset()
+			{
+				return (sizeof(control_block_shared_array) + alignof(T) - 1) / alignof(T) * alignof(T);
+			}
+			// Largest element count whose UnitCount() does not wrap.
+			static constexpr size_t MaxSize()
+			{
+				return (SIZE_MAX - ElementOffset() - (sizeof(storage_unit) - 1)) / sizeof(T);
+			}
+			static constexpr size_t UnitCount(size_t size)
+			{
+				return (ElementOffset() + size * sizeof(T) + sizeof(storage_unit) - 1) / sizeof(storage_unit);
+			}
+
+		private:
+			MTL_NO_UNIQUE_ADDRESS Alloc m_Allocator;
+			size_t m_Size;
+		};
+
+		struct shared_access;
+
+		template <typename Y, typename T>
+		concept pointer_compatible = std::is_convertible_v<Y*, T*>;
+
+		template <typename U, typename Policy>
+		enable_shared_from_this<U, Policy>* shared_from_this_base(enable_shared_from_this<U, Policy>* ptr)
+		{
+			return ptr;
+		}
+	}
+
+	template <typename T, typename Policy>
+	class shared_ptr
+	{
+		template <typename U, typename P>
+		friend class shared_ptr;
+		template <typename U, typename P>
+		friend class weak_ptr;
+		friend struct detail::shared_access;
+
+	public:
+		using element_type = std::remove_extent_t<T>;
+
+		shared_ptr() = default;
+		explicit shared_ptr(element_type* data)
+			: shared_ptr(data, default_delete<T>())
+		{
+		}
+		template <typename Deleter>
+			requires std::is_invocable_v<Deleter&, element_type*>
+		shared_ptr(element_type* data, Deleter deleter)
+			: m_Data(data)
+		{
+			try
+			{
+				m_ControlBlock = new detail::control_block<element_type, Deleter, Policy>(data, std::move(deleter));
+			}
+			catch (...)
+			{
+				deleter(data);
+				throw;
+			}
+			EnableSharedFromThis();
+		}
+		template <typename Deleter>
+		shared_ptr(unique_ptr<T, Deleter>&& rhs)
+			: shared_ptr()
+		{
+			if (rhs)
+			{
+				shared_ptr tmp(rhs.get(), std::move(rhs.get_deleter()));
+				rhs.release();
+				swap(*this, tmp);
+			}
+		}
+		explicit shared_ptr(const weak_ptr<T, Policy>& rhs)
+		{
+			if (!rhs.m_ControlBlock || !rhs.m_ControlBlock->TryIncRef())
+				throw bad_weak_ptr();
+
+			m_Data = rhs.m_Data;
+			m_ControlBlock = rhs.m_ControlBlock;
+		}
+		~shared_ptr()
+		{
+			DecRef();
+		}
+		shared_ptr(const shared_ptr& rhs)
+			: m_Data(rhs.m_Data), m_ControlBlock(rhs.m_ControlBlock)
+		{
+			IncRef();
+		}
+		shared_ptr(shared_ptr&& rhs) noexcept
+		{
+			swap(*this, rhs);
+		}
+		template <detail::pointer_compatible<T> U>
+		shared_ptr(const shared_ptr<U, Policy>& rhs)
+			: m_Data(rhs.m_Data), m_ControlBlock(rhs.m_ControlBlock)
+		{
+			IncRef();
+		}
+		template <detail::pointer_compatible<T> U>
+		shared_ptr(shared_ptr<U, Policy>&& rhs) noexcept
+			: m_Data(std::exchange(rhs.m_Data, nullptr)), m_ControlBlock(std::exchange(rhs.m_ControlBlock, nullptr))
 		{
 		}
+		// Aliasing: shares ownership with rhs but points at `data`, typically
+		// a member or sub-object of the object rhs owns.
+		template <typename U>
+		shared_ptr(const shared_ptr<U, Policy>& rhs, element_type* data) noexcept
+			: m_Data(data), m_ControlBlock(rhs.m_ControlBlock)
+		{
+			IncRef();
+		}
+		template <typename U>
+		shared_ptr(shared_ptr<U, Policy>&& rhs, element_type* data) noexcept
+			: m_Data(data), m_ControlBlock(std::exchange(rhs.m_ControlBlock, nullptr))
+		{
+			rhs.m_Data = nullptr;
+		}
+		shared_ptr& operator=(const shared_ptr& rhs)
+		{
+			if (this != &rhs)
+			{
+				DecRef();
+				m_Data = rhs.m_Data;
+				m_ControlBlock = rhs.m_ControlBlock;
+				IncRef();
+			}
+			return *this;
+		}
+		shared_ptr& operator=(shared_ptr&& rhs) noexcept
+		{
+			shared_ptr temp(std::move(rhs));
+			swap(*this, temp);
+			return *this;
+		}
+		template <detail::pointer_compatible<T> U>
+		shared_ptr& operator=(const shared_ptr<U, Policy>& rhs)
+		{
+			shared_ptr temp(rhs);
+			swap(*this, temp);
+			return *this;
+		}
+		template <detail::pointer_compatible<T> U>
+		shared_ptr& operator=(shared_ptr<U, Policy>&& rhs) noexcept
+		{
+			shared_ptr temp(std::move(rhs));
+			swap(*this, temp);
+			return *this;
+		}
+
+		element_type& operator*() const 
+		{ 
+			return *m_Data; 
+		}
+		element_type* operator->() const 
+		{ 
+			return m_Data;
+		}
+		element_type& operator[](std::ptrdiff_t index) const
+			requires std::is_array_v<T>
+		{
+			return m_Data[index];
+		}
+		element_type* get() const noexcept
+		{ 
+			return m_Data;
+		}
+		size_t use_count() const noexcept
+		{
+			return m_ControlBlock ? m_ControlBlock->RefCount() : 0;
+		}
+		template <typename U>
+		bool owner_before(const shared_ptr<U, Policy>& rhs) const noexcept
+		{
+			return std::less<>()(static_cast<const void*>(m_ControlBlock), static_cast<const void*>(rhs.m_ControlBlock));
+		}
+		void reset() noexcept
+		{
+			shared_ptr tmp;
+			swap(*this, tmp);
+		}
+		explicit operator bool() const 
+		{
+			return m_Data != nullptr;
+		}
+
+	private:
+		shared_ptr(element_type* data, detail::control_block_base<Policy>* block)
+			: m_Data(data), m_ControlBlock(block)
+		{
+		}
+		void EnableSharedFromThis()
+		{
+			if constexpr (!std::is_array_v<T> && requires (T* ptr) { detail::shared_from_this_base(ptr); })
+			{
+				if (m_Data)
+				{
+					auto base = detail::shared_from_this_base(m_Data);
+					if (base->m_WeakThis.expired())
+					{
+						using weak_type = decltype(base->m_WeakThis);
+						base->m_WeakThis = weak_type(m_Data, m_ControlBlock);
+					}
+				}
+			}
+		}
 		friend void swap(shared_ptr& lhs, shared_ptr& rhs) noexcept
 		{
 			std::swap(lhs.m_Data, rhs.m_Data);
@@ -291,10 +774,199 @@ namespace mtl
 			}
 		}
 	private:
-		T* m_Data{ nullptr };
-		control_block_base* m_ControlBlock{ nullptr };
+		element_type* m_Data{ nullptr };
+		detail::control_block_base<Policy>* m_ControlBlock{ nullptr };
 	};
 
+	template <typename T, typename Policy>
+	class weak_ptr
+	{
+		template <typename U, typename P>
+		friend class shared_ptr;
+		template <typename U, typename P>
+		friend class weak_ptr;
+
+	public:
+		using element_type = std::remove_extent_t<T>;
+
+		weak_ptr() = default;
+		weak_ptr(const shared_ptr<T, Policy>& rhs)
+			: m_Data(rhs.m_Data), m_ControlBlock(rhs.m_ControlBlock)
+		{
+			IncWeakRef();
+		}
+		~weak_ptr()
+		{
+			DecWeakRef();
+		}
+		weak_ptr(const weak_ptr& rhs)
+			: m_Data(rhs.m_Data), m_ControlBlock(rhs.m_ControlBlock)
+		{
+			IncWeakRef();
+		}
+		weak_ptr(weak_ptr&& rhs) noexcept
+		{
+			swap(*this, rhs);
+		}
+		template <detail::pointer_compatible<T> U>
+		weak_ptr(const shared_ptr<U, Policy>& rhs)
+			: m_Data(rhs.m_Data), m_ControlBlock(rhs.m_ControlBlock)
+		{
+			IncWeakRef();
+		}
+		template <detail::pointer_compatible<T> U>
+		weak_ptr(const weak_ptr<U, Policy>& rhs)
+			: m_ControlBlock(rhs.m_ControlBlock)
+		{
+			// Converting a dangling pointer may have to read a virtual base
+			// offset, so only convert while the object is still alive.
+			if (auto locked = rhs.lock())
+				m_Data = locked.get();
+			IncWeakRef();
+		}
+		weak_ptr& operator=(weak_ptr rhs) noexcept
+		{
+			swap(*this, rhs);
+			return *this;
+		}
+
+		size_t use_count() const noexcept
+		{
+			return m_ControlBlock ? m_ControlBlock->RefCount() : 0;
+		}
+		bool expired() const noexcept
+		{
+			return use_count() == 0;
+		}
+		shared_ptr<T, Policy> lock() const noexcept
+		{
+			if (m_ControlBlock && m_ControlBlock->TryIncRef())
+				return shared_ptr<T, Policy>(m_Data, m_ControlBlock);
+
+			return shared_ptr<T, Policy>();
+		}
+		void reset() noexcept
+		{
+			weak_ptr tmp;
+			swap(*this, tmp);
+		}
+
+	private:
+		weak_ptr(element_type* data, detail::control_block_base<Policy>* block)
+			: m_Data(data), m_ControlBlock(block)
+		{
+			IncWeakRef();
+		}
+		friend void swap(weak_ptr& lhs, weak_ptr& rhs) noexcept
+		{
+			std::swap(lhs.m_Data, rhs.m_Data);
+			std::swap(lhs.m_ControlBlock, rhs.m_ControlBlock);
+		}
+		void DecWeakRef()
+		{
+			if (m_ControlBlock)
+			{
+				m_ControlBlock->DecWeakRef();
+			}
+		}
+		void IncWeakRef()
+		{
+			if (m_ControlBlock)
+			{
+				m_ControlBlock->IncWeakRef();
+			}
+		}
+
+	private:
+		element_type* m_Data{ nullptr };
+		detail::control_block_base<Policy>* m_ControlBlock{ nullptr };
+	};
+
+	template <typename T, typename Policy>
+	class enable_shared_from_this
+	{
+		template <typename U, typename P>
+		friend class shared_ptr;
+
+	public:
+		shared_ptr<T, Policy> shared_from_this()
+		{
+			return shared_ptr<T, Policy>(m_WeakThis);
+		}
+		shared_ptr<const T, Policy> shared_from_this() const
+		{
+			return shared_ptr<T, Policy>(m_WeakThis);
+		}
+		weak_ptr<T, Policy> weak_from_this() const noexcept
+		{
+			return m_WeakThis;
+		}
+
+	protected:
+		enable_shared_from_this() = default;
+		enable_shared_from_this(const enable_shared_from_this&) noexcept
+		{
+		}
+		enable_shared_from_this& operator=(const enable_shared_from_this&) noexcept
+		{
+			return *this;
+		}
+		~enable_shared_from_this() = default;
+
+	private:
+		mutable weak_ptr<T, Policy> m_WeakThis;
+	};
+
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> static_pointer_cast(const shared_ptr<U, Policy>& rhs) noexcept
+	{
+		return shared_ptr<T, Policy>(rhs, static_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get()));
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> static_pointer_cast(shared_ptr<U, Policy>&& rhs) noexcept
+	{
+		auto data = static_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get());
+		return shared_ptr<T, Policy>(std::move(rhs), data);
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> dynamic_pointer_cast(const shared_ptr<U, Policy>& rhs) noexcept
+	{
+		if (auto data = dynamic_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get()))
+			return shared_ptr<T, Policy>(rhs, data);
+
+		return shared_ptr<T, Policy>();
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> dynamic_pointer_cast(shared_ptr<U, Policy>&& rhs) noexcept
+	{
+		if (auto data = dynamic_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get()))
+			return shared_ptr<T, Policy>(std::move(rhs), data);
+
+		return shared_ptr<T, Policy>();
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> const_pointer_cast(const shared_ptr<U, Policy>& rhs) noexcept
+	{
+		return shared_ptr<T, Policy>(rhs, const_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get()));
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> const_pointer_cast(shared_ptr<U, Policy>&& rhs) noexcept
+	{
+		auto data = const_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get());
+		return shared_ptr<T, Policy>(std::move(rhs), data);
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> reinterpret_pointer_cast(const shared_ptr<U, Policy>& rhs) noexcept
+	{
+		return shared_ptr<T, Policy>(rhs, reinterpret_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get()));
+	}
+	template <typename T, typename U, typename Policy>
+	shared_ptr<T, Policy> reinterpret_pointer_cast(shared_ptr<U, Policy>&& rhs) noexcept
+	{
+		auto data = reinterpret_cast<typename shared_ptr<T, Policy>::element_type*>(rhs.get());
+		return shared_ptr<T, Policy>(std::move(rhs), data);
+	}
+
 	template <non_array T, typename... Args>
 	unique_ptr<T> make_unique(Args&&... args)
 	{
@@ -306,11 +978,136 @@ namespace mtl
 		return unique_ptr<T>(new std::remove_extent_t<T>[size]());
 	}
 
+	template <non_array T>
+	unique_ptr<T> make_unique_for_overwrite()
+	{
+		return unique_ptr<T>(new T);
+	}
+	template <unbounded_array T>
+	unique_ptr<T> make_unique_for_overwrite(size_t size)
+	{
+		return unique_ptr<T>(new std::remove_extent_t<T>[size]);
+	}
+
+	namespace detail
+	{
+		struct shared_access
+		{
+			template <typename T, typename Policy, typename Block>
+			static shared_ptr<T, Policy> Adopt(Block* block)
+			{
+				shared_ptr<T, Policy> result(block->ObjPtr(), block);
+				result.EnableSharedFromThis();
+				return result;
+			}
+			template <typename T, typename Policy>
+			static shared_ptr<T, Policy> Share(T* data, control_block_base<Policy>* block)
+			{
+				block->IncRef();
+				return shared_ptr<T, Policy>(data, block);
+			}
+		};
+
+		template <typename T, typename Alloc>
+		using rebind_element_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<std::remove_extent_t<T>>;
+	}
+
+	template <non_array T, typename Policy = atomic_ref_count, typename Alloc, typename... Args>
+	shared_ptr<T, Policy> allocate_shared(const Alloc& alloc, Args&&... args)
+	{
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_shared<T, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::Create(allocator(alloc), std::forward<Args>(args)...));
+	}
+	template <unbounded_array T, typename Policy = atomic_ref_count, typename Alloc>
+	shared_ptr<T, Policy> allocate_shared(const Alloc& alloc, size_t size)
+	{
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_shared_array<std::remove_extent_t<T>, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::template Create<false>(allocator(alloc), size));
+	}
+	template <bounded_array T, typename Policy = atomic_ref_count, typename Alloc>
+	shared_ptr<T, Policy> allocate_shared(const Alloc& alloc)
+	{
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_shared_array<std::remove_extent_t<T>, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::template Create<false>(allocator(alloc), std::extent_v<T>));
+	}
+
+	template <non_array T, typename Policy = atomic_ref_count, typename Alloc>
+	shared_ptr<T, Policy> allocate_shared_for_overwrite(const Alloc& alloc)
+	{
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_shared<T, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::Create(allocator(alloc), detail::for_overwrite_t()));
+	}
+	template <unbounded_array T, typename Policy = atomic_ref_count, typename Alloc>
+	shared_ptr<T, Policy> allocate_shared_for_overwrite(const Alloc& alloc, size_t size)
+	{
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_shared_array<std::remove_extent_t<T>, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::template Create<true>(allocator(alloc), size));
+	}
+	template <bounded_array T, typename Policy = atomic_ref_count, typename Alloc>
+	shared_ptr<T, Policy> allocate_shared_for_overwrite(const Alloc& alloc)
+	{
+		using allocator = detail::rebind_element_alloc<T, Alloc>;
+		using block_type = detail::control_block_shared_array<std::remove_extent_t<T>, allocator, Policy>;
+
+		return detail::shared_access::Adopt<T, Policy>(block_type::template Create<true>(allocator(alloc), std::extent_v<T>));
+	}
+
+	template <non_array T, typename Policy = atomic_ref_count, typename... Args>
+	shared_ptr<T, Policy> make_shared(Args&&... args)
+	{
+		return allocate_shared<T, Policy>(std::allocator<T>(), std::forward<Args>(args)...);
+	}
+	template <unbounded_array T, typename Policy = atomic_ref_count>
+	shared_ptr<T, Policy> make_shared(size_t size)
+	{
+		return allocate_shared<T, Policy>(std::allocator<std::remove_extent_t<T>>(), size);
+	}
+	template <bounded_array T, typename Policy = atomic_ref_count>
+	shared_ptr<T, Policy> make_shared()
+	{
+		return allocate_shared<T, Policy>(std::allocator<std::remove_extent_t<T>>());
+	}
+
+	template <non_array T, typename Policy = atomic_ref_count>
+	shared_ptr<T, Policy> make_shared_for_overwrite()
+	{
+		return allocate_shared_for_overwrite<T, Policy>(std::allocator<T>());
+	}
+	template <unbounded_array T, typename Policy = atomic_ref_count>
+	shared_ptr<T, Policy> make_shared_for_overwrite(size_t size)
+	{
+		return allocate_shared_for_overwrite<T, Policy>(std::allocator<std::remove_extent_t<T>>(), size);
+	}
+	template <bounded_array T, typename Policy = atomic_ref_count>
+	shared_ptr<T, Policy> make_shared_for_overwrite()
+	{
+		return allocate_shared_for_overwrite<T, Policy>(std::allocator<std::remove_extent_t<T>>());
+	}
+
 	template <non_array T, typename... Args>
-	shared_ptr<T> make_shared(Args&&... args)
+	local_shared_ptr<T> make_local_shared(Args&&... args)
+	{
+		return make_shared<T, local_ref_count>(std::forward<Args>(args)...);
+	}
+	template <unbounded_array T>
+	local_shared_ptr<T> make_local_shared(size_t size)
+	{
+		return make_shared<T, local_ref_count>(size);
+	}
+	template <bounded_array T>
+	local_shared_ptr<T> make_local_shared()
 	{
-		auto block = new shared_ptr<T>::control_block_shared(std::forward<Args>(args)...);
-		return shared_ptr<T>(block);
+		return make_shared<T, local_ref_count>();
 	}
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,485 @@
+#pragma once
+#include "Vector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace mtl
+{
+	class memory_resource
+	{
+	protected:
+		static constexpr size_t MAX_ALIGN{ alignof(std::max_align_t) };
+
+	public:
+		virtual ~memory_resource() = default;
+
+		void* allocate(size_t bytes, size_t alignment = MAX_ALIGN)
+		{
+			return do_allocate(bytes, alignment);
+		}
+		void deallocate(void* ptr, size_t bytes, size_t alignment = MAX_ALIGN)
+		{
+			do_deallocate(ptr, bytes, alignment);
+		}
+		bool is_equal(const memory_resource& other) const noexcept
+		{
+			return do_is_equal(other);
+		}
+		friend bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept
+		{
+			return &lhs == &rhs || lhs.is_equal(rhs);
+		}
+
+	private:
+		virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+		virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) = 0;
+		virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+	};
+
+	namespace detail
+	{
+		class new_delete_resource final : public memory_resource
+		{
+			void* do_allocate(size_t bytes, size_t alignment) override
+			{
+				return ::operator new(bytes, std::align_val_t(alignment));
+			}
+			void do_deallocate(void* ptr, size_t, size_t alignment) override
+			{
+				::operator delete(ptr, std::align_val_t(alignment));
+			}
+			bool do_is_equal(const memory_resource& other) const noexcept override
+			{
+				return this == &other;
+			}
+		};
+
+		class null_memory_resource final : public memory_resource
+		{
+			void* do_allocate(size_t, size_t) override
+			{
+				throw std::bad_alloc();
+			}
+			void do_deallocate(void*, size_t, size_t) override
+			{
+			}
+			bool do_is_equal(const memory_resource& other) const noexcept override
+			{
+				return this == &other;
+			}
+		};
+
+		inline std::atomic<memory_resource*>& default_resource()
+		{
+			static std::atomic<memory_resource*> resource{ nullptr };
+			return resource;
+		}
+	}
+
+	inline memory_resource* new_delete_resource() noexcept
+	{
+		static detail::new_delete_resource resource;
+		return &resource;
+	}
+	// Throws std::bad_alloc on every allocation; useful as the upstream of a
+	// buffer that must never spill to the heap.
+	inline memory_resource* null_memory_resource() noexcept
+	{
+		static detail::null_memory_resource resource;
+		return &resource;
+	}
+	inline memory_resource* get_default_resource() noexcept
+	{
+		memory_resource* resource = detail::default_resource().load(std::memory_order_acquire);
+		return resource ? resource : new_delete_resource();
+	}
+	inline memory_resource* set_default_resource(memory_resource* resource) noexcept
+	{
+		memory_resource* previous = detail::default_resource().exchange(resource, std::memory_order_acq_rel);
+		return previous ? previous : new_delete_resource();
+	}
+
+	// Unlike std::pmr::polymorphic_allocator this one is assignable, because
+	// the mtl containers swap their allocators along with their contents.
+	// Containers copy-construct with the default resource and keep their own
+	// resource on assignment, as std::pmr containers do.
+	template <typename T = std::byte>
+	class polymorphic_allocator
+	{
+	public:
+		using value_type = T;
+
+		polymorphic_allocator() noexcept
+			: m_Resource(get_default_resource())
+		{
+		}
+		polymorphic_allocator(memory_resource* resource) noexcept
+			: m_Resource(resource)
+		{
+		}
+		template <typename U>
+		polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+			: m_Resource(other.resource())
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(T))
+				throw std::bad_array_new_length();
+
+			return static_cast<T*>(m_Resource->allocate(count * sizeof(T), alignof(T)));
+		}
+		void deallocate(T* ptr, size_t count)
+		{
+			m_Resource->deallocate(ptr, count * sizeof(T), alignof(T));
+		}
+		// Passes the resource on to elements that are themselves allocator-aware.
+		template <typename U, typename... Args>
+		void construct(U* ptr, Args&&... args)
+		{
+			std::uninitialized_construct_using_allocator(ptr, *this, std::forward<Args>(args)...);
+		}
+		polymorphic_allocator select_on_container_copy_construction() const noexcept
+		{
+			return polymorphic_allocator();
+		}
+		memory_resource* resource() const noexcept
+		{
+			return m_Resource;
+		}
+
+	private:
+		memory_resource* m_Resource;
+	};
+
+	template <typename T, typename U>
+	bool operator==(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept
+	{
+		return *lhs.resource() == *rhs.resource();
+	}
+
+	// Bump allocation out of geometrically growing chunks. deallocate() is a
+	// no-op; everything is handed back at once by release() or destruction.
+	class monotonic_buffer_resource : public memory_resource
+	{
+		static constexpr size_t GROWTH_FACTOR{ 2 };
+		static constexpr size_t DEFAULT_CHUNK{ 1024 };
+
+		// Stored at the start of each upstream chunk.
+		struct chunk
+		{
+			chunk* next;
+			size_t bytes;
+			size_t alignment;
+		};
+
+	public:
+		explicit monotonic_buffer_resource(memory_resource* upstream = get_default_resource()) noexcept
+			: m_Upstream(upstream)
+		{
+		}
+		explicit monotonic_buffer_resource(size_t initial_size, memory_resource* upstream = get_default_resource()) noexcept
+			: m_Upstream(upstream), m_NextSize(std::max<size_t>(initial_size, 1))
+		{
+		}
+		monotonic_buffer_resource(void* buffer, size_t size, memory_resource* upstream = get_default_resource()) noexcept
+			: m_Upstream(upstream), m_InitialBuffer(static_cast<std::byte*>(buffer)), m_InitialSize(size)
+			, m_Current(m_InitialBuffer), m_End(m_InitialBuffer + size), m_NextSize(std::max<size_t>(size * GROWTH_FACTOR, DEFAULT_CHUNK))
+		{
+		}
+		~monotonic_buffer_resource() override
+		{
+			release();
+		}
+		monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+		monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+		// Returns every chunk to upstream and rewinds to the initial buffer.
+		void release()
+		{
+			while (m_Chunks)
+			{
+				chunk* next = m_Chunks->next;
+				m_Upstream->deallocate(m_Chunks, m_Chunks->bytes, m_Chunks->alignment);
+				m_Chunks = next;
+			}
+			m_Current = m_InitialBuffer;
+			m_End = m_InitialBuffer + m_InitialSize;
+		}
+		memory_resource* upstream_resource() const noexcept
+		{
+			return m_Upstream;
+		}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			if (void* ptr = Bump(bytes, alignment))
+				return ptr;
+
+			size_t chunk_alignment = std::max(alignment, alignof(chunk));
+			size_t chunk_bytes = std::max(m_NextSize, sizeof(chunk) + bytes + alignment);
+			auto block = static_cast<chunk*>(m_Upstream->allocate(chunk_bytes, chunk_alignment));
+			*block = { m_Chunks, chunk_bytes, chunk_alignment };
+			m_Chunks = block;
+			m_Current = reinterpret_cast<std::byte*>(block + 1);
+			m_End = reinterpret_cast<std::byte*>(block) + chunk_bytes;
+			m_NextSize = chunk_bytes * GROWTH_FACTOR;
+			return Bump(bytes, alignment);
+		}
+		void do_deallocate(void*, size_t, size_t) override
+		{
+		}
+		bool do_is_equal(const memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+		void* Bump(size_t bytes, size_t alignment) noexcept
+		{
+			if (!m_Current)
+				return nullptr;
+
+			void* ptr = m_Current;
+			size_t space = static_cast<size_t>(m_End - m_Current);
+			if (!std::align(alignment, bytes, ptr, space))
+				return nullptr;
+
+			m_Current = static_cast<std::byte*>(ptr) + bytes;
+			return ptr;
+		}
+
+	private:
+		memory_resource* m_Upstream;
+		std::byte* m_InitialBuffer{ nullptr };
+		size_t m_InitialSize{ 0 };
+		std::byte* m_Current{ nullptr };
+		std::byte* m_End{ nullptr };
+		size_t m_NextSize{ DEFAULT_CHUNK };
+		chunk* m_Chunks{ nullptr };
+	};
+
+	struct pool_options
+	{
+		// Zero selects the implementation default for either field.
+		size_t max_blocks_per_chunk{ 0 };
+		size_t largest_required_pool_block{ 0 };
+	};
+
+	// Power-of-two size classes, each carving blocks out of chunks obtained
+	// from upstream and recycling them through a free list. Requests larger
+	// than the largest pool block go straight to upstream. Not thread-safe.
+	class unsynchronized_pool_resource : public memory_resource
+	{
+		static constexpr size_t MIN_BLOCK{ 8 };
+		static constexpr size_t DEFAULT_LARGEST_BLOCK{ 4096 };
+		static constexpr size_t MAX_LARGEST_BLOCK{ 64 * 1024 };
+		static constexpr size_t FIRST_CHUNK_BLOCKS{ 16 };
+		static constexpr size_t DEFAULT_MAX_BLOCKS{ 1024 };
+
+		struct free_block
+		{
+			free_block* next;
+		};
+		// Stored at the end of each chunk, past its blocks.
+		struct chunk
+		{
+			chunk* next;
+			size_t bytes;
+		};
+		struct pool
+		{
+			size_t block_size;
+			size_t next_blocks{ FIRST_CHUNK_BLOCKS };
+			free_block* free{ nullptr };
+			chunk* chunks{ nullptr };
+		};
+		struct oversized
+		{
+			void* ptr;
+			size_t bytes;
+			size_t alignment;
+		};
+
+	public:
+		unsynchronized_pool_resource() noexcept
+			: unsynchronized_pool_resource(pool_options(), get_default_resource())
+		{
+		}
+		explicit unsynchronized_pool_resource(memory_resource* upstream) noexcept
+			: unsynchronized_pool_resource(pool_options(), upstream)
+		{
+		}
+		explicit unsynchronized_pool_resource(const pool_options& options, memory_resource* upstream = get_default_resource()) noexcept
+			: m_Upstream(upstream)
+		{
+			m_Options.largest_required_pool_block = std::bit_ceil(std::clamp(options.largest_required_pool_block ? options.largest_required_pool_block : DEFAULT_LARGEST_BLOCK, MIN_BLOCK, MAX_LARGEST_BLOCK));
+			m_Options.max_blocks_per_chunk = std::max(options.max_blocks_per_chunk ? options.max_blocks_per_chunk : DEFAULT_MAX_BLOCKS, FIRST_CHUNK_BLOCKS);
+
+			m_PoolCount = PoolIndex(m_Options.largest_required_pool_block) + 1;
+			for (size_t i = 0; i < m_PoolCount; ++i)
+				m_Pools[i].block_size = MIN_BLOCK << i;
+		}
+		~unsynchronized_pool_resource() override
+		{
+			release();
+		}
+		unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+		unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+		// Returns all memory to upstream, even blocks that are still in use.
+		void release()
+		{
+			for (size_t i = 0; i < m_PoolCount; ++i)
+			{
+				pool& target = m_Pools[i];
+				while (chunk* current = target.chunks)
+				{
+					target.chunks = current->next;
+					std::byte* base = reinterpret_cast<std::byte*>(current + 1) - current->bytes;
+					m_Upstream->deallocate(base, current->bytes, target.block_size);
+				}
+				target.free = nullptr;
+				target.next_blocks = FIRST_CHUNK_BLOCKS;
+			}
+			for (auto& block : m_Oversized)
+				m_Upstream->deallocate(block.ptr, block.bytes, block.alignment);
+			m_Oversized.clear();
+		}
+		memory_resource* upstream_resource() const noexcept
+		{
+			return m_Upstream;
+		}
+		pool_options options() const noexcept
+		{
+			return m_Options;
+		}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			size_t size = std::max(bytes, alignment);
+			if (size > m_Options.largest_required_pool_block)
+			{
+				void* ptr = m_Upstream->allocate(bytes, alignment);
+				m_Oversized.push_back({ ptr, bytes, alignment });
+				return ptr;
+			}
+
+			pool& target = m_Pools[PoolIndex(size)];
+			if (!target.free)
+				Refill(target);
+
+			free_block* block = target.free;
+			target.free = block->next;
+			return block;
+		}
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+		{
+			size_t size = std::max(bytes, alignment);
+			if (size > m_Options.largest_required_pool_block)
+			{
+				for (size_t i = 0; i < m_Oversized.size(); ++i)
+				{
+					if (m_Oversized[i].ptr == ptr)
+					{
+						m_Oversized[i] = m_Oversized[m_Oversized.size() - 1];
+						m_Oversized.pop_back();
+						break;
+					}
+				}
+				m_Upstream->deallocate(ptr, bytes, alignment);
+				return;
+			}
+
+			pool& target = m_Pools[PoolIndex(size)];
+			target.free = ::new (ptr) free_block{ target.free };
+		}
+		bool do_is_equal(const memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	private:
+		static size_t PoolIndex(size_t size) noexcept
+		{
+			return std::bit_width(std::max(size, MIN_BLOCK) - 1) - std::bit_width(MIN_BLOCK - 1);
+		}
+		// Blocks are aligned to their own size because each chunk is.
+		void Refill(pool& target)
+		{
+			size_t blocks = target.next_blocks;
+			size_t bytes = blocks * target.block_size + sizeof(chunk);
+			auto base = static_cast<std::byte*>(m_Upstream->allocate(bytes, target.block_size));
+			auto header = ::new (base + blocks * target.block_size) chunk{ target.chunks, bytes };
+			target.chunks = header;
+			for (size_t i = blocks; i-- > 0;)
+				target.free = ::new (base + i * target.block_size) free_block{ target.free };
+
+			target.next_blocks = std::min(blocks * 2, m_Options.max_blocks_per_chunk);
+		}
+
+	private:
+		static constexpr size_t MAX_POOLS{ 14 };
+
+		memory_resource* m_Upstream;
+		pool_options m_Options;
+		pool m_Pools[MAX_POOLS]{};
+		size_t m_PoolCount{ 0 };
+		mtl::vector<oversized> m_Oversized;
+	};
+
+	// unsynchronized_pool_resource behind a mutex.
+	class synchronized_pool_resource : public memory_resource
+	{
+	public:
+		synchronized_pool_resource() noexcept = default;
+		explicit synchronized_pool_resource(memory_resource* upstream) noexcept
+			: m_Pool(upstream)
+		{
+		}
+		explicit synchronized_pool_resource(const pool_options& options, memory_resource* upstream = get_default_resource()) noexcept
+			: m_Pool(options, upstream)
+		{
+		}
+
+		void release()
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Pool.release();
+		}
+		memory_resource* upstream_resource() const noexcept
+		{
+			return m_Pool.upstream_resource();
+		}
+		pool_options options() const noexcept
+		{
+			return m_Pool.options();
+		}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Pool.allocate(bytes, alignment);
+		}
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Pool.deallocate(ptr, bytes, alignment);
+		}
+		bool do_is_equal(const memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	private:
+		std::mutex m_Mutex;
+		unsynchronized_pool_resource m_Pool;
+	};
+}
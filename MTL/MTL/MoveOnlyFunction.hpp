@@ -0,0 +1,264 @@
+#pragma once
+#include "Memory.hpp"
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mtl
+{
+	// Types whose objects can be moved by copying their bytes and abandoning
+	// the source without running its destructor. Specialize it for types that
+	// qualify without being trivially copyable, such as owning pointers.
+	template <typename T>
+	struct is_trivially_relocatable
+		: std::bool_constant<std::is_trivially_move_constructible_v<T> && std::is_trivially_destructible_v<T>>
+	{
+	};
+	template <typename T>
+	inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	template <typename T, typename Deleter>
+	struct is_trivially_relocatable<unique_ptr<T, Deleter>> : is_trivially_relocatable<Deleter>
+	{
+	};
+	template <typename T, typename Policy>
+	struct is_trivially_relocatable<shared_ptr<T, Policy>> : std::true_type
+	{
+	};
+	template <typename T, typename Policy>
+	struct is_trivially_relocatable<weak_ptr<T, Policy>> : std::true_type
+	{
+	};
+
+	template <typename Signature, size_t InlineSize = 5 * sizeof(void*)>
+	class move_only_function;
+
+	namespace detail
+	{
+		template <typename T>
+		struct is_move_only_function : std::false_type
+		{
+		};
+		template <typename Signature, size_t InlineSize>
+		struct is_move_only_function<move_only_function<Signature, InlineSize>> : std::true_type
+		{
+		};
+
+		template <typename T>
+		struct is_in_place_type : std::false_type
+		{
+		};
+		template <typename T>
+		struct is_in_place_type<std::in_place_type_t<T>> : std::true_type
+		{
+		};
+	}
+
+	// Owning callable wrapper for move-only callables. Callables that fit in
+	// InlineSize bytes and move without throwing are stored in place, the rest
+	// on the heap. Calls go through a single function pointer chosen at
+	// construction rather than a vtable. Moving copies the storage bytes
+	// unless an inline callable is not trivially relocatable; a heap-stored
+	// callable only ever moves its pointer.
+	// The default buffer makes the whole object 64 bytes on 64-bit targets.
+	template <typename R, typename... Args, bool Noexcept, size_t InlineSize>
+	class move_only_function<R(Args...) noexcept(Noexcept), InlineSize>
+	{
+		union storage
+		{
+			void* heap;
+			alignas(void*) unsigned char bytes[InlineSize];
+		};
+
+		using invoke_fn = R (*)(storage&, Args&&...) noexcept(Noexcept);
+		using relocate_fn = void (*)(storage& to, storage& from) noexcept;
+		using destroy_fn = void (*)(storage&) noexcept;
+
+		template <typename F>
+		static constexpr bool is_callable = Noexcept
+			? std::is_nothrow_invocable_r_v<R, F&, Args...>
+			: std::is_invocable_r_v<R, F&, Args...>;
+
+	public:
+		using result_type = R;
+
+		// Whether a callable of type F is stored in place rather than on the heap.
+		template <typename F>
+		static constexpr bool fits_inline = sizeof(F) <= sizeof(storage) && alignof(F) <= alignof(storage)
+			&& (std::is_nothrow_move_constructible_v<F> || is_trivially_relocatable_v<F>);
+
+		move_only_function() noexcept = default;
+		move_only_function(std::nullptr_t) noexcept
+		{
+		}
+		template <typename F>
+			requires (!std::is_same_v<std::remove_cvref_t<F>, move_only_function>
+				&& !detail::is_in_place_type<std::remove_cvref_t<F>>::value
+				&& std::is_constructible_v<std::decay_t<F>, F>
+				&& is_callable<std::decay_t<F>>)
+		move_only_function(F&& func)
+		{
+			using stored = std::decay_t<F>;
+			if constexpr (std::is_pointer_v<stored> || std::is_member_pointer_v<stored> || detail::is_move_only_function<stored>::value)
+			{
+				if (func == nullptr)
+					return;
+			}
+			Emplace<stored>(std::forward<F>(func));
+		}
+		template <typename F, typename... CArgs>
+			requires (std::is_constructible_v<F, CArgs...> && is_callable<F>)
+		explicit move_only_function(std::in_place_type_t<F>, CArgs&&... args)
+		{
+			static_assert(std::is_same_v<F, std::decay_t<F>>, "move_only_function stores callables by value");
+			Emplace<F>(std::forward<CArgs>(args)...);
+		}
+		move_only_function(const move_only_function&) = delete;
+		move_only_function(move_only_function&& rhs) noexcept
+		{
+			TakeFrom(rhs);
+		}
+		~move_only_function()
+		{
+			if (m_Destroy)
+				m_Destroy(m_Storage);
+		}
+
+		move_only_function& operator=(const move_only_function&) = delete;
+		move_only_function& operator=(move_only_function&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				Reset();
+				TakeFrom(rhs);
+			}
+			return *this;
+		}
+		move_only_function& operator=(std::nullptr_t) noexcept
+		{
+			Reset();
+			return *this;
+		}
+		template <typename F>
+			requires std::is_constructible_v<move_only_function, F>
+		move_only_function& operator=(F&& func)
+		{
+			return *this = move_only_function(std::forward<F>(func));
+		}
+
+		// Calling an empty move_only_function throws std::bad_function_call,
+		// or terminates if the signature is noexcept.
+		R operator()(Args... args) noexcept(Noexcept)
+		{
+			return m_Invoke(m_Storage, std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return m_Invoke != &InvokeEmpty;
+		}
+
+		friend bool operator==(const move_only_function& func, std::nullptr_t) noexcept
+		{
+			return !func;
+		}
+		friend void swap(move_only_function& lhs, move_only_function& rhs) noexcept
+		{
+			move_only_function tmp(std::move(lhs));
+			lhs = std::move(rhs);
+			rhs = std::move(tmp);
+		}
+
+	private:
+		template <typename F, bool Inline>
+		static F& Target(storage& data) noexcept
+		{
+			if constexpr (Inline)
+				return *std::launder(reinterpret_cast<F*>(data.bytes));
+			else
+				return *static_cast<F*>(data.heap);
+		}
+
+		template <typename F, bool Inline>
+		static R Invoke(storage& data, Args&&... args) noexcept(Noexcept)
+		{
+			if constexpr (std::is_void_v<R>)
+				std::invoke(Target<F, Inline>(data), std::forward<Args>(args)...);
+			else
+				return std::invoke(Target<F, Inline>(data), std::forward<Args>(args)...);
+		}
+		static R InvokeEmpty(storage&, Args&&...) noexcept(Noexcept)
+		{
+			if constexpr (Noexcept)
+				std::terminate();
+			else
+				throw std::bad_function_call();
+		}
+		template <typename F>
+		static void Relocate(storage& to, storage& from) noexcept
+		{
+			F& source = Target<F, true>(from);
+			::new (static_cast<void*>(to.bytes)) F(std::move(source));
+			source.~F();
+		}
+		template <typename F, bool Inline>
+		static void Destroy(storage& data) noexcept
+		{
+			if constexpr (Inline)
+				Target<F, true>(data).~F();
+			else
+				delete &Target<F, false>(data);
+		}
+
+		template <typename F, typename... CArgs>
+		void Emplace(CArgs&&... args)
+		{
+			if constexpr (fits_inline<F>)
+			{
+				::new (static_cast<void*>(m_Storage.bytes)) F(std::forward<CArgs>(args)...);
+				if constexpr (!is_trivially_relocatable_v<F>)
+					m_Relocate = &Relocate<F>;
+				if constexpr (!std::is_trivially_destructible_v<F>)
+					m_Destroy = &Destroy<F, true>;
+			}
+			else
+			{
+				m_Storage.heap = new F(std::forward<CArgs>(args)...);
+				m_Destroy = &Destroy<F, false>;
+			}
+			m_Invoke = &Invoke<F, fits_inline<F>>;
+		}
+		void TakeFrom(move_only_function& rhs) noexcept
+		{
+			if (rhs.m_Relocate)
+				rhs.m_Relocate(m_Storage, rhs.m_Storage);
+			else
+				std::memcpy(static_cast<void*>(&m_Storage), &rhs.m_Storage, sizeof(storage));
+
+			m_Invoke = std::exchange(rhs.m_Invoke, &InvokeEmpty);
+			m_Relocate = std::exchange(rhs.m_Relocate, nullptr);
+			m_Destroy = std::exchange(rhs.m_Destroy, nullptr);
+		}
+		void Reset() noexcept
+		{
+			if (m_Destroy)
+				m_Destroy(m_Storage);
+
+			m_Invoke = &InvokeEmpty;
+			m_Relocate = nullptr;
+			m_Destroy = nullptr;
+		}
+
+	private:
+		storage m_Storage;
+		invoke_fn m_Invoke{ &InvokeEmpty };
+		// Null when a memcpy of the storage is enough.
+		relocate_fn m_Relocate{ nullptr };
+		// Null when the stored callable is trivially destructible.
+		destroy_fn m_Destroy{ nullptr };
+	};
+}
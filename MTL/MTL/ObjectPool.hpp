@@ -0,0 +1,134 @@
+#pragma once
+#include "Memory.hpp"
+#include "ReclamationDomain.hpp"
+
+namespace mtl
+{
+	// Brings a recycled object back to a reusable state: calls reset() or
+	// clear() when T has one, and leaves the object untouched otherwise.
+	template <typename T>
+	struct default_pool_reset
+	{
+		void operator()(T& object) const
+		{
+			if constexpr (requires { object.reset(); })
+				object.reset();
+			else if constexpr (requires { object.clear(); })
+				object.clear();
+		}
+	};
+
+	template <typename T, typename Reset = default_pool_reset<T>>
+	class object_pool
+	{
+		struct local_cache
+		{
+			mtl::vector<T*> objects;
+			std::atomic<bool> owned{ false };
+			local_cache* next{ nullptr };
+		};
+
+	public:
+		class deleter
+		{
+		public:
+			deleter() noexcept = default;
+			explicit deleter(object_pool* pool) noexcept
+				: m_Pool(pool)
+			{
+			}
+			void operator()(T* object) const
+			{
+				m_Pool->Release(object);
+			}
+
+		private:
+			object_pool* m_Pool{ nullptr };
+		};
+		using handle = unique_ptr<T, deleter>;
+
+		// Each thread caches up to local_capacity idle objects before moving
+		// half of them to the shared overflow list.
+		explicit object_pool(size_t local_capacity = 64, Reset reset = Reset())
+			: m_Id(detail::domain_registry::get().add()), m_LocalCapacity(std::max<size_t>(local_capacity, 2)), m_Reset(std::move(reset))
+		{
+		}
+		// Requires that every handle has been returned.
+		~object_pool()
+		{
+			detail::domain_registry::get().remove(m_Id);
+			for (auto cache = m_Caches.load(std::memory_order_acquire); cache; cache = cache->next)
+			{
+				for (T* object : cache->objects)
+					delete object;
+			}
+			detail::destroy_slots(m_Caches);
+			for (T* object : m_Overflow)
+				delete object;
+		}
+		object_pool(const object_pool&) = delete;
+		object_pool& operator=(const object_pool&) = delete;
+
+		// Returns an idle object, or a new default-constructed one when the
+		// pool is empty.
+		handle acquire()
+		{
+			local_cache& cache = LocalCache();
+			if (cache.objects.empty())
+				Refill(cache);
+
+			if (!cache.objects.empty())
+			{
+				T* object = cache.objects[cache.objects.size() - 1];
+				cache.objects.pop_back();
+				return handle(object, deleter(this));
+			}
+			m_Created.fetch_add(1, std::memory_order_relaxed);
+			return handle(new T(), deleter(this));
+		}
+		// Objects constructed by the pool so far; the rest were reused.
+		size_t created() const noexcept
+		{
+			return m_Created.load(std::memory_order_relaxed);
+		}
+
+	private:
+		void Release(T* object)
+		{
+			m_Reset(*object);
+			local_cache& cache = LocalCache();
+			cache.objects.push_back(object);
+			if (cache.objects.size() > m_LocalCapacity)
+			{
+				std::lock_guard lock(m_Mutex);
+				for (size_t i = 0; i < m_LocalCapacity / 2; ++i)
+				{
+					m_Overflow.push_back(cache.objects[cache.objects.size() - 1]);
+					cache.objects.pop_back();
+				}
+			}
+		}
+		void Refill(local_cache& cache)
+		{
+			std::lock_guard lock(m_Mutex);
+			for (size_t i = 0; i < m_LocalCapacity / 2 && !m_Overflow.empty(); ++i)
+			{
+				cache.objects.push_back(m_Overflow[m_Overflow.size() - 1]);
+				m_Overflow.pop_back();
+			}
+		}
+		local_cache& LocalCache()
+		{
+			return detail::thread_slots<local_cache>::local(this, m_Id, m_Caches);
+		}
+
+	private:
+		std::uint64_t m_Id;
+		size_t m_LocalCapacity;
+		MTL_NO_UNIQUE_ADDRESS Reset m_Reset;
+		std::atomic<local_cache*> m_Caches{ nullptr };
+		std::atomic<size_t> m_Created{ 0 };
+		std::mutex m_Mutex;
+		mtl::vector<T*> m_Overflow;
+	};
+}
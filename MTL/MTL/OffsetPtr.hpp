@@ -0,0 +1,183 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace mtl
+{
+	// Pointer that stores the distance from itself to its target instead of
+	// an address, so a structure linked with offset_ptrs stays valid wherever
+	// the memory holding it is mapped, as long as pointer and target move
+	// together. Copying recomputes the distance for the destination. An
+	// offset of 1 marks null, because 0 is a legitimate self-reference (an
+	// empty list's sentinel points at itself).
+	template <typename T>
+	class offset_ptr
+	{
+		template <typename>
+		friend class offset_ptr;
+
+		static constexpr ptrdiff_t NULL_OFFSET{ 1 };
+
+	public:
+		using element_type = T;
+		using value_type = std::remove_cv_t<T>;
+		using difference_type = ptrdiff_t;
+		using pointer = offset_ptr;
+		using reference = std::add_lvalue_reference_t<T>;
+		using iterator_category = std::random_access_iterator_tag;
+		using iterator_concept = std::random_access_iterator_tag;
+
+		template <typename U>
+		using rebind = offset_ptr<U>;
+
+		offset_ptr() noexcept = default;
+		offset_ptr(std::nullptr_t) noexcept
+		{
+		}
+		offset_ptr(T* ptr) noexcept
+		{
+			Set(ptr);
+		}
+		offset_ptr(const offset_ptr& rhs) noexcept
+		{
+			Set(rhs.get());
+		}
+		template <typename U>
+			requires std::is_convertible_v<U*, T*>
+		offset_ptr(const offset_ptr<U>& rhs) noexcept
+		{
+			Set(rhs.get());
+		}
+		// Allocators hand out offset_ptr<void> as their void_pointer.
+		template <typename U>
+			requires (std::is_void_v<U> && !std::is_void_v<T>)
+		explicit offset_ptr(const offset_ptr<U>& rhs) noexcept
+		{
+			Set(static_cast<T*>(rhs.get()));
+		}
+		offset_ptr& operator=(const offset_ptr& rhs) noexcept
+		{
+			Set(rhs.get());
+			return *this;
+		}
+		offset_ptr& operator=(T* ptr) noexcept
+		{
+			Set(ptr);
+			return *this;
+		}
+		offset_ptr& operator=(std::nullptr_t) noexcept
+		{
+			m_Offset = NULL_OFFSET;
+			return *this;
+		}
+
+		template <typename U = T>
+			requires (!std::is_void_v<U>)
+		static offset_ptr pointer_to(U& ref) noexcept
+		{
+			return offset_ptr(std::addressof(ref));
+		}
+
+		T* get() const noexcept
+		{
+			if (m_Offset == NULL_OFFSET)
+				return nullptr;
+
+			return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + m_Offset);
+		}
+		T* operator->() const noexcept
+		{
+			return get();
+		}
+		reference operator*() const noexcept
+			requires (!std::is_void_v<T>)
+		{
+			return *get();
+		}
+		reference operator[](ptrdiff_t index) const noexcept
+			requires (!std::is_void_v<T>)
+		{
+			return get()[index];
+		}
+		explicit operator bool() const noexcept
+		{
+			return m_Offset != NULL_OFFSET;
+		}
+
+		offset_ptr& operator+=(ptrdiff_t n) noexcept
+		{
+			Set(get() + n);
+			return *this;
+		}
+		offset_ptr& operator-=(ptrdiff_t n) noexcept
+		{
+			Set(get() - n);
+			return *this;
+		}
+		offset_ptr& operator++() noexcept
+		{
+			return *this += 1;
+		}
+		offset_ptr operator++(int) noexcept
+		{
+			offset_ptr tmp(*this);
+			++*this;
+			return tmp;
+		}
+		offset_ptr& operator--() noexcept
+		{
+			return *this -= 1;
+		}
+		offset_ptr operator--(int) noexcept
+		{
+			offset_ptr tmp(*this);
+			--*this;
+			return tmp;
+		}
+		friend offset_ptr operator+(const offset_ptr& ptr, ptrdiff_t n) noexcept
+		{
+			return offset_ptr(ptr.get() + n);
+		}
+		friend offset_ptr operator+(ptrdiff_t n, const offset_ptr& ptr) noexcept
+		{
+			return offset_ptr(ptr.get() + n);
+		}
+		friend offset_ptr operator-(const offset_ptr& ptr, ptrdiff_t n) noexcept
+		{
+			return offset_ptr(ptr.get() - n);
+		}
+		friend ptrdiff_t operator-(const offset_ptr& lhs, const offset_ptr& rhs) noexcept
+		{
+			return lhs.get() - rhs.get();
+		}
+
+		friend bool operator==(const offset_ptr& lhs, const offset_ptr& rhs) noexcept
+		{
+			return lhs.get() == rhs.get();
+		}
+		friend bool operator==(const offset_ptr& lhs, std::nullptr_t) noexcept
+		{
+			return !lhs;
+		}
+		friend std::strong_ordering operator<=>(const offset_ptr& lhs, const offset_ptr& rhs) noexcept
+		{
+			return std::compare_three_way{}(lhs.get(), rhs.get());
+		}
+
+	private:
+		void Set(T* ptr) noexcept
+		{
+			if (!ptr)
+			{
+				m_Offset = NULL_OFFSET;
+				return;
+			}
+			m_Offset = static_cast<ptrdiff_t>(reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(this));
+		}
+
+		ptrdiff_t m_Offset{ NULL_OFFSET };
+	};
+}
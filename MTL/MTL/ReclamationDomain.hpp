@@ -0,0 +1,157 @@
+#pragma once
+#include "Vector.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+// Plumbing shared by the reclamation domains and object pools: each domain
+// owns a lock-free list of per-thread slots, and threads cache the slot they
+// hold for every domain they have touched.
+namespace mtl::detail
+{
+	struct retired_object
+	{
+		void* ptr;
+		void (*reclaim)(void*);
+	};
+
+	// Ids of live domains, so an exiting thread can tell whether the slots
+	// it still references belong to a destroyed domain.
+	class domain_registry
+	{
+	public:
+		static domain_registry& get()
+		{
+			static domain_registry* registry = new domain_registry();
+			return *registry;
+		}
+
+		std::uint64_t add()
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Live.push_back(m_NextId);
+			return m_NextId++;
+		}
+		void remove(std::uint64_t id)
+		{
+			std::lock_guard lock(m_Mutex);
+			for (size_t i = 0; i < m_Live.size(); ++i)
+			{
+				if (m_Live[i] == id)
+				{
+					m_Live[i] = m_Live[m_Live.size() - 1];
+					m_Live.pop_back();
+					return;
+				}
+			}
+		}
+		template <typename F>
+		void for_live(F&& f)
+		{
+			std::lock_guard lock(m_Mutex);
+			f([this](std::uint64_t id) {
+				for (std::uint64_t live : m_Live)
+				{
+					if (live == id)
+						return true;
+				}
+				return false;
+			});
+		}
+
+	private:
+		std::mutex m_Mutex;
+		mtl::vector<std::uint64_t> m_Live;
+		std::uint64_t m_NextId{ 1 };
+	};
+
+	// Slot must provide `std::atomic<bool> owned` and `Slot* next`.
+	template <typename Slot>
+	Slot* claim_slot(std::atomic<Slot*>& head)
+	{
+		for (Slot* slot = head.load(std::memory_order_acquire); slot; slot = slot->next)
+		{
+			if (!slot->owned.load(std::memory_order_relaxed) && !slot->owned.exchange(true, std::memory_order_acquire))
+				return slot;
+		}
+		Slot* slot = new Slot();
+		slot->owned.store(true, std::memory_order_relaxed);
+		slot->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+		return slot;
+	}
+
+	template <typename Slot>
+	void release_slot(Slot* slot)
+	{
+		slot->owned.store(false, std::memory_order_release);
+	}
+
+	template <typename Slot>
+	void destroy_slots(std::atomic<Slot*>& head)
+	{
+		Slot* slot = head.exchange(nullptr, std::memory_order_acquire);
+		while (slot)
+			delete std::exchange(slot, slot->next);
+	}
+
+	// The slots the current thread holds, one per domain it has touched.
+	// Slots of domains still alive at thread exit are released for reuse.
+	template <typename Slot>
+	class thread_slots
+	{
+		struct entry
+		{
+			const void* domain;
+			std::uint64_t id;
+			Slot* slot;
+		};
+
+	public:
+		~thread_slots()
+		{
+			domain_registry::get().for_live([this](auto alive) {
+				for (const entry& item : m_Entries)
+				{
+					if (alive(item.id))
+						release_slot(item.slot);
+				}
+			});
+		}
+
+		static Slot& local(const void* domain, std::uint64_t id, std::atomic<Slot*>& head)
+		{
+			thread_local thread_slots t_Slots;
+			return t_Slots.find(domain, id, head);
+		}
+
+	private:
+		Slot& find(const void* domain, std::uint64_t id, std::atomic<Slot*>& head)
+		{
+			for (auto& item : m_Entries)
+			{
+				if (item.domain == domain && item.id == id)
+					return *item.slot;
+			}
+
+			Slot* slot = claim_slot(head);
+			for (auto& item : m_Entries)
+			{
+				// A destroyed domain used to live at this address.
+				if (item.domain == domain)
+				{
+					item = { domain, id, slot };
+					return *slot;
+				}
+			}
+			m_Entries.push_back({ domain, id, slot });
+			return *slot;
+		}
+
+	private:
+		mtl::vector<entry> m_Entries;
+	};
+}
@@ -0,0 +1,552 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include "OffsetPtr.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mtl
+{
+	namespace detail
+	{
+		// Lives at the start of every segment. Everything inside refers to the
+		// segment through offset_ptr, so each process may map it anywhere.
+		struct segment_header
+		{
+			static constexpr uint64_t MAGIC{ 0x4D544C5345474D31 };
+			static constexpr size_t ALIGNMENT{ 16 };
+			static constexpr size_t NAME_LENGTH{ 48 };
+			static constexpr size_t DIRECTORY_SIZE{ 32 };
+
+			// Allocated blocks keep their size in a 16-byte prefix; free blocks
+			// reuse that prefix for the free list link.
+			struct free_block
+			{
+				size_t size;
+				offset_ptr<free_block> next;
+			};
+			static constexpr size_t BLOCK_HEADER{ ALIGNMENT };
+			static constexpr size_t MIN_BLOCK{ 2 * ALIGNMENT };
+			static_assert(sizeof(free_block) <= MIN_BLOCK);
+
+			struct named_object
+			{
+				char name[NAME_LENGTH];
+				offset_ptr<void> object;
+			};
+
+			// Spin lock rather than a mutex: a lock-free atomic works across
+			// processes on every platform without extra setup.
+			class lock_guard
+			{
+			public:
+				explicit lock_guard(segment_header& header) noexcept
+					: m_Lock(header.lock)
+				{
+					while (m_Lock.exchange(1, std::memory_order_acquire) != 0)
+					{
+						while (m_Lock.load(std::memory_order_relaxed) != 0)
+							std::this_thread::yield();
+					}
+				}
+				lock_guard(const lock_guard&) = delete;
+				lock_guard& operator=(const lock_guard&) = delete;
+				~lock_guard()
+				{
+					m_Lock.store(0, std::memory_order_release);
+				}
+
+			private:
+				std::atomic<uint32_t>& m_Lock;
+			};
+
+			// Written last with release, so a process that sees the magic
+			// through an acquire load sees a usable heap.
+			std::atomic<uint64_t> magic;
+			size_t size;
+			std::atomic<uint32_t> lock;
+			size_t free_bytes;
+			offset_ptr<free_block> free_list;
+			named_object directory[DIRECTORY_SIZE];
+
+			// Lock-free atomics carry no process-local state, so they work
+			// across mappings.
+			static_assert(std::atomic<uint32_t>::is_always_lock_free);
+			static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+			static constexpr size_t align_up(size_t bytes) noexcept
+			{
+				return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+			}
+
+			void initialize(size_t total) noexcept
+			{
+				size = total;
+				lock.store(0, std::memory_order_relaxed);
+				for (named_object& entry : directory)
+				{
+					entry.name[0] = '\0';
+					entry.object = nullptr;
+				}
+
+				size_t offset = align_up(sizeof(segment_header));
+				auto* first = reinterpret_cast<free_block*>(reinterpret_cast<std::byte*>(this) + offset);
+				first->size = (total - offset) & ~(ALIGNMENT - 1);
+				first->next = nullptr;
+				free_list = first;
+				free_bytes = first->size;
+				magic.store(MAGIC, std::memory_order_release);
+			}
+
+			// First fit over an address-ordered free list. The block is carved
+			// from the end of the free block it is found in, so a split leaves
+			// the list untouched.
+			void* allocate(size_t bytes)
+			{
+				if (bytes > size)
+					throw std::bad_alloc();
+
+				size_t needed = std::max(align_up(bytes) + BLOCK_HEADER, MIN_BLOCK);
+				lock_guard guard{ *this };
+
+				offset_ptr<free_block>* link = &free_list;
+				while (*link && (*link)->size < needed)
+					link = &(*link)->next;
+				if (!*link)
+					throw std::bad_alloc();
+
+				free_block* block = link->get();
+				std::byte* result;
+				if (block->size - needed >= MIN_BLOCK)
+				{
+					block->size -= needed;
+					result = reinterpret_cast<std::byte*>(block) + block->size;
+				}
+				else
+				{
+					needed = block->size;
+					*link = block->next;
+					result = reinterpret_cast<std::byte*>(block);
+				}
+				*reinterpret_cast<size_t*>(result) = needed;
+				free_bytes -= needed;
+				return result + BLOCK_HEADER;
+			}
+			void deallocate(void* ptr) noexcept
+			{
+				if (!ptr)
+					return;
+
+				std::byte* start = static_cast<std::byte*>(ptr) - BLOCK_HEADER;
+				size_t block_size = *reinterpret_cast<size_t*>(start);
+				lock_guard guard{ *this };
+				free_bytes += block_size;
+
+				free_block* prev = nullptr;
+				free_block* next = free_list.get();
+				while (next && reinterpret_cast<std::byte*>(next) < start)
+				{
+					prev = next;
+					next = next->next.get();
+				}
+
+				auto* block = reinterpret_cast<free_block*>(start);
+				block->size = block_size;
+				block->next = next;
+				if (next && start + block_size == reinterpret_cast<std::byte*>(next))
+				{
+					block->size += next->size;
+					block->next = next->next;
+				}
+
+				if (prev && reinterpret_cast<std::byte*>(prev) + prev->size == start)
+				{
+					prev->size += block->size;
+					prev->next = block->next;
+				}
+				else if (prev)
+					prev->next = block;
+				else
+					free_list = block;
+			}
+
+			named_object* find(std::string_view name) noexcept
+			{
+				for (named_object& entry : directory)
+				{
+					if (entry.object && name == entry.name)
+						return &entry;
+				}
+				return nullptr;
+			}
+		};
+	}
+
+	// A named region of shared memory (shm_open/mmap, or a pagefile-backed
+	// file mapping on Windows) with a heap and a directory of named objects
+	// inside it. A producer creates the segment and constructs containers that
+	// use segment_allocator; consumers open it by name and read the same
+	// objects in place. Containers are not synchronized: coordinate writers
+	// and readers externally. The segment outlives every mapping until
+	// remove() is called.
+	class shared_segment
+	{
+	public:
+		static constexpr size_t DIRECTORY_SIZE{ detail::segment_header::DIRECTORY_SIZE };
+
+		struct create_t
+		{
+			explicit create_t() = default;
+		};
+		struct open_t
+		{
+			explicit open_t() = default;
+		};
+		static constexpr create_t create{};
+		static constexpr open_t open{};
+
+		shared_segment(create_t, std::string_view name, size_t size)
+		{
+			if (size < 2 * sizeof(detail::segment_header))
+				throw std::invalid_argument("shared_segment is too small");
+
+			Map(name, size, true);
+			m_Header->initialize(size);
+		}
+		shared_segment(open_t, std::string_view name)
+		{
+			Map(name, 0, false);
+			if (m_Header->magic.load(std::memory_order_acquire) != detail::segment_header::MAGIC)
+			{
+				Unmap();
+				throw std::runtime_error("shared_segment is not initialized");
+			}
+		}
+		shared_segment(const shared_segment&) = delete;
+		shared_segment& operator=(const shared_segment&) = delete;
+		shared_segment(shared_segment&& rhs) noexcept
+			: m_Header(std::exchange(rhs.m_Header, nullptr)), m_Size(std::exchange(rhs.m_Size, 0))
+#if defined(_WIN32)
+			, m_Handle(std::exchange(rhs.m_Handle, nullptr))
+#endif
+		{
+		}
+		shared_segment& operator=(shared_segment&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				Unmap();
+				m_Header = std::exchange(rhs.m_Header, nullptr);
+				m_Size = std::exchange(rhs.m_Size, 0);
+#if defined(_WIN32)
+				m_Handle = std::exchange(rhs.m_Handle, nullptr);
+#endif
+			}
+			return *this;
+		}
+		~shared_segment()
+		{
+			Unmap();
+		}
+
+		// Deletes the name; existing mappings stay valid. A no-op on Windows,
+		// where the mapping disappears with its last handle.
+		static bool remove(std::string_view name)
+		{
+#if defined(_WIN32)
+			(void)name;
+			return true;
+#else
+			return shm_unlink(PosixName(name).c_str()) == 0;
+#endif
+		}
+
+		void* allocate(size_t bytes)
+		{
+			return m_Header->allocate(bytes);
+		}
+		void deallocate(void* ptr) noexcept
+		{
+			m_Header->deallocate(ptr);
+		}
+
+		// Constructs a T in the segment and registers it under name. Throws
+		// if the name is taken or the directory is full.
+		template <typename T, typename... Args>
+		T* construct(std::string_view name, Args&&... args)
+		{
+			static_assert(alignof(T) <= detail::segment_header::ALIGNMENT, "shared_segment objects are at most 16-byte aligned");
+			if (name.empty() || name.size() >= detail::segment_header::NAME_LENGTH)
+				throw std::invalid_argument("shared_segment object name is empty or too long");
+
+			void* memory = allocate(sizeof(T));
+			T* object;
+			try
+			{
+				object = ::new (memory) T(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				deallocate(memory);
+				throw;
+			}
+
+			{
+				detail::segment_header::lock_guard guard{ *m_Header };
+				if (!m_Header->find(name))
+				{
+					for (detail::segment_header::named_object& entry : m_Header->directory)
+					{
+						if (!entry.object)
+						{
+							std::memcpy(entry.name, name.data(), name.size());
+							entry.name[name.size()] = '\0';
+							entry.object = object;
+							return object;
+						}
+					}
+				}
+			}
+			object->~T();
+			deallocate(memory);
+			throw std::runtime_error("shared_segment object name is taken or the directory is full");
+		}
+		// The caller vouches that the object registered under name is a T.
+		template <typename T>
+		T* find(std::string_view name) const
+		{
+			detail::segment_header::lock_guard guard{ *m_Header };
+			detail::segment_header::named_object* entry = m_Header->find(name);
+			return entry ? static_cast<T*>(entry->object.get()) : nullptr;
+		}
+		template <typename T>
+		bool destroy(std::string_view name)
+		{
+			T* object;
+			{
+				detail::segment_header::lock_guard guard{ *m_Header };
+				detail::segment_header::named_object* entry = m_Header->find(name);
+				if (!entry)
+					return false;
+
+				object = static_cast<T*>(entry->object.get());
+				entry->object = nullptr;
+			}
+			object->~T();
+			deallocate(object);
+			return true;
+		}
+
+		size_t size() const noexcept
+		{
+			return m_Size;
+		}
+		size_t free_bytes() const noexcept
+		{
+			detail::segment_header::lock_guard guard{ *m_Header };
+			return m_Header->free_bytes;
+		}
+		void* base() const noexcept
+		{
+			return m_Header;
+		}
+		bool contains(const void* ptr) const noexcept
+		{
+			auto address = reinterpret_cast<uintptr_t>(ptr);
+			auto start = reinterpret_cast<uintptr_t>(m_Header);
+			return address >= start && address < start + m_Size;
+		}
+		detail::segment_header& header() const noexcept
+		{
+			return *m_Header;
+		}
+
+	private:
+#if !defined(_WIN32)
+		static std::string PosixName(std::string_view name)
+		{
+			std::string result;
+			if (name.empty() || name.front() != '/')
+				result += '/';
+			result += name;
+			return result;
+		}
+#endif
+		void Map(std::string_view name, size_t size, bool create)
+		{
+#if defined(_WIN32)
+			std::string object_name(name);
+			if (create)
+			{
+				m_Handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+					static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), object_name.c_str());
+				if (m_Handle && GetLastError() == ERROR_ALREADY_EXISTS)
+				{
+					CloseHandle(m_Handle);
+					m_Handle = nullptr;
+					SetLastError(ERROR_ALREADY_EXISTS);
+				}
+			}
+			else
+				m_Handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, object_name.c_str());
+			if (!m_Handle)
+				throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "shared_segment");
+
+			void* view = MapViewOfFile(m_Handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+			if (!view)
+			{
+				DWORD error = GetLastError();
+				CloseHandle(m_Handle);
+				m_Handle = nullptr;
+				throw std::system_error(static_cast<int>(error), std::system_category(), "shared_segment");
+			}
+			MEMORY_BASIC_INFORMATION info;
+			VirtualQuery(view, &info, sizeof(info));
+			m_Header = static_cast<detail::segment_header*>(view);
+			m_Size = create ? size : info.RegionSize;
+#else
+			std::string object_name = PosixName(name);
+			int fd = shm_open(object_name.c_str(), create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+			if (fd < 0)
+				throw std::system_error(errno, std::generic_category(), "shm_open");
+
+			struct stat info;
+			if ((create && ftruncate(fd, static_cast<off_t>(size)) != 0) || fstat(fd, &info) != 0)
+			{
+				int error = errno;
+				close(fd);
+				if (create)
+					shm_unlink(object_name.c_str());
+				throw std::system_error(error, std::generic_category(), "shared_segment");
+			}
+
+			size = static_cast<size_t>(info.st_size);
+			void* view = size >= sizeof(detail::segment_header)
+				? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+				: MAP_FAILED;
+			int error = errno;
+			close(fd);
+			if (view == MAP_FAILED)
+			{
+				if (create)
+					shm_unlink(object_name.c_str());
+				throw std::system_error(size < sizeof(detail::segment_header) ? EINVAL : error, std::generic_category(), "mmap");
+			}
+			m_Header = static_cast<detail::segment_header*>(view);
+			m_Size = size;
+#endif
+		}
+		void Unmap() noexcept
+		{
+			if (!m_Header)
+				return;
+#if defined(_WIN32)
+			UnmapViewOfFile(m_Header);
+			CloseHandle(m_Handle);
+			m_Handle = nullptr;
+#else
+			munmap(m_Header, m_Size);
+#endif
+			m_Header = nullptr;
+		}
+
+		detail::segment_header* m_Header{};
+		size_t m_Size{};
+#if defined(_WIN32)
+		HANDLE m_Handle{};
+#endif
+	};
+
+	// Allocator over a shared_segment. It hands out offset_ptr and refers to
+	// the segment through one, so containers built with it can live inside
+	// the segment and be used from any process that maps it.
+	template <typename T>
+	class segment_allocator
+	{
+		template <typename>
+		friend class segment_allocator;
+
+	public:
+		using value_type = T;
+		using pointer = offset_ptr<T>;
+		using const_pointer = offset_ptr<const T>;
+		using void_pointer = offset_ptr<void>;
+		using const_void_pointer = offset_ptr<const void>;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = segment_allocator<U>;
+		};
+
+		segment_allocator(shared_segment& segment) noexcept
+			: m_Header(&segment.header())
+		{
+		}
+		segment_allocator(const segment_allocator& rhs) noexcept
+			: m_Header(rhs.m_Header)
+		{
+		}
+		template <typename U>
+		segment_allocator(const segment_allocator<U>& rhs) noexcept
+			: m_Header(rhs.m_Header)
+		{
+		}
+		segment_allocator& operator=(const segment_allocator& rhs) noexcept
+		{
+			m_Header = rhs.m_Header;
+			return *this;
+		}
+
+		pointer allocate(size_t count)
+		{
+			static_assert(alignof(T) <= detail::segment_header::ALIGNMENT, "segment_allocator supports at most 16-byte alignment");
+			if (count > SIZE_MAX / sizeof(T))
+				throw std::bad_array_new_length();
+
+			return pointer(static_cast<T*>(m_Header->allocate(count * sizeof(T))));
+		}
+		void deallocate(pointer ptr, size_t) noexcept
+		{
+			m_Header->deallocate(ptr.get());
+		}
+
+		detail::segment_header& header() const noexcept
+		{
+			return *m_Header;
+		}
+
+		template <typename U>
+		friend bool operator==(const segment_allocator& lhs, const segment_allocator<U>& rhs) noexcept
+		{
+			return &lhs.header() == &rhs.header();
+		}
+
+	private:
+		offset_ptr<detail::segment_header> m_Header;
+	};
+}
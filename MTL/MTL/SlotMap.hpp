@@ -0,0 +1,243 @@
+#pragma once
+#include "Vector.hpp"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace mtl
+{
+	// 64-bit reference to a slot_map element: the slot it lives in and the
+	// generation that slot had when the element was inserted. The default
+	// handle never refers to anything.
+	struct slot_handle
+	{
+		uint32_t index{ 0 };
+		uint32_t generation{ 0 };
+
+		uint64_t to_bits() const noexcept
+		{
+			return static_cast<uint64_t>(generation) << 32 | index;
+		}
+		static slot_handle from_bits(uint64_t bits) noexcept
+		{
+			return { static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32) };
+		}
+
+		friend bool operator==(const slot_handle&, const slot_handle&) = default;
+	};
+
+	// Values kept densely in one vector, addressed through stable handles.
+	// Lookup and erase are O(1); erase moves the last value into the hole, so
+	// iteration order is not insertion order and T must be move-assignable.
+	// A slot's generation is odd while it holds a value and even while it is
+	// free, so a handle to an erased element never matches again until the
+	// slot has been reused 2^31 times, after which the slot is retired.
+	template <typename T, typename Alloc = std::allocator<T>>
+	class slot_map
+	{
+		struct slot
+		{
+			// Position in m_Values while live, next free slot while free.
+			uint32_t index;
+			uint32_t generation;
+		};
+
+		using alloc_traits = std::allocator_traits<Alloc>;
+		using slot_allocator = typename alloc_traits::template rebind_alloc<slot>;
+		using index_allocator = typename alloc_traits::template rebind_alloc<uint32_t>;
+
+		static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+	public:
+		using value_type = T;
+		using allocator_type = Alloc;
+		using handle = slot_handle;
+		using iterator = typename vector<T, Alloc>::iterator;
+
+		slot_map() = default;
+		explicit slot_map(const Alloc& alloc)
+			: m_Values(alloc), m_Owners(index_allocator(alloc)), m_Slots(slot_allocator(alloc))
+		{
+		}
+		slot_map(const slot_map&) = default;
+		slot_map(slot_map&& rhs) noexcept
+			: m_Values(std::move(rhs.m_Values)), m_Owners(std::move(rhs.m_Owners)), m_Slots(std::move(rhs.m_Slots)),
+			m_FreeHead(std::exchange(rhs.m_FreeHead, NO_SLOT))
+		{
+		}
+		slot_map& operator=(const slot_map&) = default;
+		slot_map& operator=(slot_map&& rhs) noexcept
+		{
+			slot_map tmp(std::move(rhs));
+			swap(*this, tmp);
+			return *this;
+		}
+
+		allocator_type get_allocator() const noexcept
+		{
+			return m_Values.get_allocator();
+		}
+
+		handle insert(const T& value)
+		{
+			return emplace(value);
+		}
+		handle insert(T&& value)
+		{
+			return emplace(std::move(value));
+		}
+		template <typename... Args>
+		handle emplace(Args&&... args)
+		{
+			const uint32_t dense = static_cast<uint32_t>(m_Values.size());
+			const bool reuse = m_FreeHead != NO_SLOT;
+			const uint32_t index = reuse ? m_FreeHead : static_cast<uint32_t>(m_Slots.size());
+			if (!reuse && index == NO_SLOT)
+				throw std::length_error("mtl::slot_map has run out of slots");
+
+			m_Owners.push_back(index);
+			try
+			{
+				m_Values.emplace_back(std::forward<Args>(args)...);
+				if (!reuse)
+					m_Slots.push_back({ dense, 0 });
+			}
+			catch (...)
+			{
+				if (m_Values.size() > dense)
+					m_Values.pop_back();
+				m_Owners.pop_back();
+				throw;
+			}
+
+			slot& target = m_Slots[index];
+			if (reuse)
+				m_FreeHead = target.index;
+			target.index = dense;
+			++target.generation;
+			return { index, target.generation };
+		}
+
+		// Returns false if the handle no longer refers to anything.
+		bool erase(handle key)
+		{
+			if (!contains(key))
+				return false;
+
+			const uint32_t dense = m_Slots[key.index].index;
+			const uint32_t last = static_cast<uint32_t>(m_Values.size() - 1);
+			if (dense != last)
+			{
+				m_Values[dense] = std::move(m_Values[last]);
+				m_Owners[dense] = m_Owners[last];
+				m_Slots[m_Owners[dense]].index = dense;
+			}
+			m_Values.pop_back();
+			m_Owners.pop_back();
+			Release(key.index);
+			return true;
+		}
+		void clear()
+		{
+			for (size_t i = 0; i < m_Owners.size(); ++i)
+				Release(m_Owners[i]);
+			m_Values.clear();
+			m_Owners.clear();
+		}
+		void reserve(size_t capacity)
+		{
+			m_Values.reserve(capacity);
+			m_Owners.reserve(capacity);
+			m_Slots.reserve(capacity);
+		}
+
+		bool contains(handle key) const noexcept
+		{
+			return key.index < m_Slots.size() && m_Slots[key.index].generation == key.generation && (key.generation & 1);
+		}
+		T* find(handle key) noexcept
+		{
+			return contains(key) ? &m_Values[m_Slots[key.index].index] : nullptr;
+		}
+		const T* find(handle key) const noexcept
+		{
+			return contains(key) ? &m_Values[m_Slots[key.index].index] : nullptr;
+		}
+		T& at(handle key)
+		{
+			if (T* value = find(key))
+				return *value;
+			throw std::out_of_range("mtl::slot_map handle does not refer to a live element");
+		}
+		const T& at(handle key) const
+		{
+			if (const T* value = find(key))
+				return *value;
+			throw std::out_of_range("mtl::slot_map handle does not refer to a live element");
+		}
+		// Unchecked; the handle must refer to a live element.
+		T& operator[](handle key) noexcept
+		{
+			return m_Values[m_Slots[key.index].index];
+		}
+		const T& operator[](handle key) const noexcept
+		{
+			return m_Values[m_Slots[key.index].index];
+		}
+
+		// Handle of the value at a position in iteration order.
+		handle handle_at(size_t position) const noexcept
+		{
+			const uint32_t index = m_Owners[position];
+			return { index, m_Slots[index].generation };
+		}
+
+		iterator begin() const noexcept
+		{
+			return m_Values.begin();
+		}
+		iterator end() const noexcept
+		{
+			return m_Values.end();
+		}
+		T* data() const noexcept
+		{
+			return m_Values.data();
+		}
+		size_t size() const noexcept
+		{
+			return m_Values.size();
+		}
+		bool empty() const noexcept
+		{
+			return m_Values.empty();
+		}
+
+	private:
+		void Release(uint32_t index) noexcept
+		{
+			slot& target = m_Slots[index];
+			if (++target.generation == 0)
+				return;
+
+			target.index = m_FreeHead;
+			m_FreeHead = index;
+		}
+
+		friend void swap(slot_map& lhs, slot_map& rhs) noexcept
+		{
+			swap(lhs.m_Values, rhs.m_Values);
+			swap(lhs.m_Owners, rhs.m_Owners);
+			swap(lhs.m_Slots, rhs.m_Slots);
+			std::swap(lhs.m_FreeHead, rhs.m_FreeHead);
+		}
+
+	private:
+		vector<T, Alloc> m_Values;
+		// Slot that owns each value, for fixing up the slot of a moved value.
+		vector<uint32_t, index_allocator> m_Owners;
+		vector<slot, slot_allocator> m_Slots;
+		uint32_t m_FreeHead{ NO_SLOT };
+	};
+}
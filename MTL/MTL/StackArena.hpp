@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+
+namespace mtl
+{
+	// Bump arena over an inline buffer of N bytes, meant to live on the stack
+	// next to the short-lived containers it serves. Requests that do not fit
+	// overflow to the heap. Only the most recent allocation is reclaimed on
+	// deallocate; everything else stays used until reset() or the end of the
+	// arena's scope. A growing vector allocates its new buffer before it
+	// frees the old one, so each growth step strands the old buffer.
+	template <size_t N, size_t Align = alignof(std::max_align_t)>
+	class stack_arena
+	{
+		static_assert(Align > 0 && (Align & (Align - 1)) == 0, "stack_arena alignment must be a power of two");
+		static_assert(N % Align == 0, "stack_arena size must be a multiple of its alignment");
+
+	public:
+		static constexpr size_t size = N;
+		static constexpr size_t alignment = Align;
+
+		stack_arena() noexcept = default;
+		stack_arena(const stack_arena&) = delete;
+		stack_arena& operator=(const stack_arena&) = delete;
+
+		void* allocate(size_t bytes)
+		{
+			// AlignUp would wrap to a size that fits the buffer.
+			if (bytes > SIZE_MAX - (Align - 1))
+				throw std::bad_alloc();
+
+			bytes = AlignUp(bytes);
+			if (static_cast<size_t>(m_Buffer + N - m_Ptr) >= bytes)
+			{
+				std::byte* result = m_Ptr;
+				m_Ptr += bytes;
+				return result;
+			}
+			return ::operator new(bytes, std::align_val_t{ Align });
+		}
+		void deallocate(void* ptr, size_t bytes) noexcept
+		{
+			if (!owns(ptr))
+			{
+				::operator delete(ptr, std::align_val_t{ Align });
+				return;
+			}
+			if (static_cast<std::byte*>(ptr) + AlignUp(bytes) == m_Ptr)
+				m_Ptr = static_cast<std::byte*>(ptr);
+		}
+
+		bool owns(const void* ptr) const noexcept
+		{
+			return std::less_equal<const void*>{}(m_Buffer, ptr) && std::less<const void*>{}(ptr, m_Buffer + N);
+		}
+		size_t used() const noexcept
+		{
+			return static_cast<size_t>(m_Ptr - m_Buffer);
+		}
+		// Only valid once nothing allocated from the buffer is still in use.
+		void reset() noexcept
+		{
+			m_Ptr = m_Buffer;
+		}
+
+	private:
+		static constexpr size_t AlignUp(size_t bytes) noexcept
+		{
+			return (bytes + Align - 1) & ~(Align - 1);
+		}
+
+		alignas(Align) std::byte m_Buffer[N];
+		std::byte* m_Ptr{ m_Buffer };
+	};
+
+	template <typename T, size_t N, size_t Align = alignof(std::max_align_t)>
+	class short_alloc
+	{
+		static_assert(alignof(T) <= Align, "short_alloc alignment is too small for T");
+
+	public:
+		using value_type = T;
+		using arena_type = stack_arena<N, Align>;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = short_alloc<U, N, Align>;
+		};
+
+		short_alloc(arena_type& arena) noexcept
+			: m_Arena(&arena)
+		{
+		}
+		template <typename U>
+		short_alloc(const short_alloc<U, N, Align>& other) noexcept
+			: m_Arena(&other.arena())
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(T))
+				throw std::bad_array_new_length();
+
+			return static_cast<T*>(m_Arena->allocate(count * sizeof(T)));
+		}
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			m_Arena->deallocate(ptr, count * sizeof(T));
+		}
+
+		arena_type& arena() const noexcept
+		{
+			return *m_Arena;
+		}
+
+	private:
+		arena_type* m_Arena;
+	};
+
+	template <typename T, typename U, size_t N, size_t Align>
+	bool operator==(const short_alloc<T, N, Align>& lhs, const short_alloc<U, N, Align>& rhs) noexcept
+	{
+		return &lhs.arena() == &rhs.arena();
+	}
+}
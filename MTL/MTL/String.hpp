@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <cstring>
 #include "Memory.hpp"
 #include <variant>
 #include <array>
@@ -8,41 +9,80 @@
 
 namespace mtl
 {
-	class string
+	template <typename T>
+	class polymorphic_allocator;
+
+	template <typename Alloc = std::allocator<char>>
+	class basic_string
 	{
 		static constexpr size_t SMALL_STRING{ 16 };
 		using small_string = std::array<char, SMALL_STRING>;
-		using large_string = mtl::unique_ptr<char[]>;
+		using alloc_traits = std::allocator_traits<Alloc>;
+		// The allocator's pointer type, so the heap buffer of a string in
+		// shared memory is held through an offset_ptr.
+		using large_string = typename alloc_traits::pointer;
 
 	public:
-		string() = default;
-		~string() = default;
-		string(const char* data)
+		using allocator_type = Alloc;
+
+		basic_string() = default;
+		~basic_string()
+		{
+			if (m_Capacity > SMALL_STRING)
+				alloc_traits::deallocate(m_Allocator, std::get<large_string>(m_SSO), m_Capacity + 1);
+		}
+		explicit basic_string(const Alloc& alloc)
+			: m_Allocator(alloc)
+		{
+		}
+		basic_string(const char* data, const Alloc& alloc = Alloc())
+			: m_Allocator(alloc)
 		{
 			copy_init(data);
 		}
-		string(const string& rhs)
+		basic_string(const basic_string& rhs)
+			: m_Allocator(alloc_traits::select_on_container_copy_construction(rhs.m_Allocator))
 		{
 			copy_init(rhs.c_str());
 		}
-		string(string&& rhs) noexcept
+		basic_string(const basic_string& rhs, const Alloc& alloc)
+			: m_Allocator(alloc)
+		{
+			copy_init(rhs.c_str());
+		}
+		basic_string(basic_string&& rhs) noexcept
+			: m_Allocator(rhs.m_Allocator)
+		{
+			swap_contents(rhs);
+		}
+		basic_string(basic_string&& rhs, const Alloc& alloc)
+			: m_Allocator(alloc)
 		{
-			swap(*this, rhs);
+			if (m_Allocator == rhs.m_Allocator)
+				swap_contents(rhs);
+			else
+				copy_init(rhs.c_str());
 		}
-		string& operator=(const string& rhs)
+		basic_string& operator=(const basic_string& rhs)
 		{
 			if (this != &rhs)
 				return operator=(rhs.c_str());
 
 			return *this;
 		}
-		string& operator=(string&& rhs) noexcept
+		// Keeps this string's allocator unless the allocator propagates.
+		basic_string& operator=(basic_string&& rhs) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
 		{
-			string tmp(std::move(rhs));
+			if constexpr (!alloc_traits::propagate_on_container_move_assignment::value && !alloc_traits::is_always_equal::value)
+			{
+				if (!(m_Allocator == rhs.m_Allocator))
+					return operator=(rhs.c_str());
+			}
+			basic_string tmp(std::move(rhs));
 			swap(*this, tmp);
 			return *this;
 		}
-		string& operator=(const char* rhs)
+		basic_string& operator=(const char* rhs)
 		{
 			if (auto length = std::strlen(rhs); m_Capacity > length)
 			{
@@ -52,8 +92,8 @@ namespace mtl
 			}
 			else
 			{
-				string tmp(rhs);
-				swap(*this, tmp);
+				basic_string tmp(rhs, m_Allocator);
+				swap_contents(tmp);
 			}
 			return *this;
 		}
@@ -66,25 +106,25 @@ namespace mtl
 			return data()[index];
 		}
 
-		friend bool operator==(const string& lhs, const string& rhs)
+		friend bool operator==(const basic_string& lhs, const basic_string& rhs)
 		{
 			return std::strcmp(lhs.c_str(), rhs.c_str()) == 0;
 		}
-		friend auto operator<=>(const string& lhs, const string& rhs)
+		friend auto operator<=>(const basic_string& lhs, const basic_string& rhs)
 		{
 			return std::strcmp(lhs.c_str(), rhs.c_str());
 		}
-		friend string operator+(const string& lhs, const string& rhs)
+		friend basic_string operator+(const basic_string& lhs, const basic_string& rhs)
 		{
-			string res(lhs.c_str(), lhs.m_Length + rhs.m_Length);
+			basic_string res(lhs.c_str(), lhs.m_Length + rhs.m_Length, alloc_traits::select_on_container_copy_construction(lhs.m_Allocator));
 			std::copy_n(rhs.c_str(), rhs.m_Length + 1, res.data() + lhs.m_Length);
 			return res;
 		}
-		friend string& operator+=(string& lhs, const string& rhs)
+		friend basic_string& operator+=(basic_string& lhs, const basic_string& rhs)
 		{
 			return operator+=(lhs, rhs.c_str());
 		}
-		friend string& operator+=(string& lhs, const char* rhs)
+		friend basic_string& operator+=(basic_string& lhs, const char* rhs)
 		{
 			auto length = std::strlen(rhs);
 			if (lhs.m_Capacity > lhs.m_Length + length)
@@ -94,11 +134,13 @@ namespace mtl
 			}
 			else
 			{
-				lhs = lhs + rhs;
+				basic_string res(lhs.c_str(), lhs.m_Length + length, lhs.m_Allocator);
+				std::copy_n(rhs, length + 1, res.data() + lhs.m_Length);
+				lhs.swap_contents(res);
 			}
 			return lhs;
 		}
-		friend std::ostream& operator<<(std::ostream& os, const string& str)
+		friend std::ostream& operator<<(std::ostream& os, const basic_string& str)
 		{
 			return os << str.c_str();
 		}
@@ -107,21 +149,21 @@ namespace mtl
 		const char* c_str() const noexcept
 		{
 			if (m_Capacity > SMALL_STRING)
-				return std::get<large_string>(m_SSO).get();
+				return std::to_address(std::get<large_string>(m_SSO));
 			else
 				return std::get<small_string>(m_SSO).data();
 		}
 		char* data() noexcept
 		{ 
 			if (m_Capacity > SMALL_STRING)
-				return std::get<large_string>(m_SSO).get();
+				return std::to_address(std::get<large_string>(m_SSO));
 			else
 				return std::get<small_string>(m_SSO).data();
 		}
 		const char* data() const noexcept
 		{
 			if (m_Capacity > SMALL_STRING)
-				return std::get<large_string>(m_SSO).get();
+				return std::to_address(std::get<large_string>(m_SSO));
 			else
 				return std::get<small_string>(m_SSO).data();
 		}
@@ -141,17 +183,27 @@ namespace mtl
 		{
 			return m_Length == 0;
 		}
+		allocator_type get_allocator() const noexcept
+		{
+			return m_Allocator;
+		}
 
 	private:
-		string(const char* data, size_t buffer_size)
+		basic_string(const char* data, size_t buffer_size, const Alloc& alloc)
+			: m_Allocator(alloc)
 		{
 			copy_init(data, buffer_size);
 		}
-		friend void swap(string& lhs, string& rhs) noexcept
+		void swap_contents(basic_string& rhs) noexcept
 		{
-			std::swap(lhs.m_SSO, rhs.m_SSO);
-			std::swap(lhs.m_Length, rhs.m_Length);
-			std::swap(lhs.m_Capacity, rhs.m_Capacity);
+			std::swap(m_SSO, rhs.m_SSO);
+			std::swap(m_Length, rhs.m_Length);
+			std::swap(m_Capacity, rhs.m_Capacity);
+		}
+		friend void swap(basic_string& lhs, basic_string& rhs) noexcept
+		{
+			lhs.swap_contents(rhs);
+			std::swap(lhs.m_Allocator, rhs.m_Allocator);
 		}
 		void copy_init(const char* data, std::optional<size_t> buffer_size = std::nullopt)
 		{
@@ -166,10 +218,11 @@ namespace mtl
 			}
 			else
 			{
+				// Left uninitialized: the copy below overwrites it.
 				m_Capacity = m_Length + m_Length / 2;
-				auto heap = mtl::make_unique<char[]>(m_Capacity + 1);
-				std::copy_n(data, string_length + 1, heap.get());
-				m_SSO = std::move(heap);
+				large_string heap = alloc_traits::allocate(m_Allocator, m_Capacity + 1);
+				std::copy_n(data, string_length + 1, std::to_address(heap));
+				m_SSO = heap;
 			}
 		}
 		
@@ -177,5 +230,13 @@ namespace mtl
 		std::variant<small_string, large_string> m_SSO;
 		size_t m_Length{ 0 };
 		size_t m_Capacity{ SMALL_STRING };
+		MTL_NO_UNIQUE_ADDRESS Alloc m_Allocator;
 	};
-}
\ No newline at end of file
+
+	using string = basic_string<>;
+
+	namespace pmr
+	{
+		using string = basic_string<polymorphic_allocator<char>>;
+	}
+}
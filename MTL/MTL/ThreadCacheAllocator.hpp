@@ -0,0 +1,351 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include "ThreadLocalCache.hpp"
+
+namespace mtl
+{
+	struct thread_cache_stats
+	{
+		size_t arenas_reserved;
+		size_t bytes_reserved;
+		size_t spans_carved;
+		size_t batches_fetched;
+		size_t batches_released;
+	};
+
+	namespace detail
+	{
+		// Size-class heap in the style of tcmalloc. Small requests are rounded
+		// up to a size class and served from a per-thread free list; lists
+		// exchange fixed-size batches with a mutex-guarded central list per
+		// class, which in turn carves new spans of pages out of the page heap.
+		// Larger requests take whole page runs from the page heap. Memory is
+		// recycled but never returned to the system.
+		class thread_cache_heap
+		{
+		public:
+			static constexpr size_t PAGE_SIZE{ 8 * 1024 };
+			static constexpr size_t MAX_SMALL{ 32 * 1024 };
+			static constexpr size_t MIN_ALIGN{ 16 };
+			// 16..128 in steps of 16, then four classes per power of two.
+			static constexpr size_t CLASS_COUNT{ 8 + 4 * (std::bit_width(MAX_SMALL) - 8) };
+
+			static constexpr size_t class_size(size_t cls) noexcept
+			{
+				if (cls < 8)
+					return (cls + 1) * 16;
+
+				size_t power = 8 + (cls - 8) / 4;
+				return (size_t(1) << (power - 1)) + ((cls - 8) % 4 + 1) * (size_t(1) << (power - 3));
+			}
+			static constexpr size_t class_index(size_t bytes) noexcept
+			{
+				if (bytes <= 128)
+					return (std::max<size_t>(bytes, 1) + 15) / 16 - 1;
+
+				size_t power = std::bit_width(bytes - 1);
+				return 8 + (power - 8) * 4 + (bytes - (size_t(1) << (power - 1)) - 1) / (size_t(1) << (power - 3));
+			}
+			// Objects moved between a thread cache and the central list at once.
+			static constexpr size_t batch_size(size_t cls) noexcept
+			{
+				return std::clamp<size_t>(64 * 1024 / class_size(cls), 2, 32);
+			}
+
+			static void* allocate(size_t bytes, size_t alignment)
+			{
+				if (alignment > MIN_ALIGN)
+					return ::operator new(bytes, std::align_val_t(alignment));
+				if (bytes > MAX_SMALL)
+					return AllocateLarge(bytes);
+
+				size_t cls = class_index(bytes);
+				free_list& list = local_cache::get().lists[cls];
+				if (!list.head)
+					Fetch(list, cls);
+
+				free_node* node = list.head;
+				list.head = node->next;
+				--list.length;
+				return node;
+			}
+			static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept
+			{
+				if (!ptr)
+					return;
+				if (alignment > MIN_ALIGN)
+				{
+					::operator delete(ptr, std::align_val_t(alignment));
+					return;
+				}
+				if (bytes > MAX_SMALL)
+				{
+					DeallocateLarge(ptr, bytes);
+					return;
+				}
+
+				size_t cls = class_index(bytes);
+				free_list& list = local_cache::get().lists[cls];
+				auto node = static_cast<free_node*>(ptr);
+				node->next = list.head;
+				list.head = node;
+				if (++list.length >= 2 * batch_size(cls) || local_cache::flushed())
+					Release(list, cls);
+			}
+			static thread_cache_stats stats() noexcept
+			{
+				auto& counters = Global().counters;
+				return {
+					counters.arenas_reserved.load(std::memory_order_relaxed),
+					counters.bytes_reserved.load(std::memory_order_relaxed),
+					counters.spans_carved.load(std::memory_order_relaxed),
+					counters.batches_fetched.load(std::memory_order_relaxed),
+					counters.batches_released.load(std::memory_order_relaxed)
+				};
+			}
+
+		private:
+			static constexpr size_t MAX_SPAN_PAGES{ 128 };
+			static constexpr size_t ARENA_PAGES{ MAX_SPAN_PAGES };
+
+			struct free_node
+			{
+				free_node* next;
+				free_node* next_batch;
+			};
+			struct free_list
+			{
+				free_node* head;
+				size_t length;
+			};
+			struct thread_cache
+			{
+				free_list lists[CLASS_COUNT];
+			};
+			struct central_list
+			{
+				std::mutex mutex;
+				free_node* batches{ nullptr };
+			};
+			// Free page runs are kept in one list per run length.
+			struct page_heap
+			{
+				std::mutex mutex;
+				free_node* runs[MAX_SPAN_PAGES + 1]{};
+				std::byte* arena{ nullptr };
+				size_t arena_pages{ 0 };
+			};
+			struct heap_counters
+			{
+				std::atomic<size_t> arenas_reserved{ 0 };
+				std::atomic<size_t> bytes_reserved{ 0 };
+				std::atomic<size_t> spans_carved{ 0 };
+				std::atomic<size_t> batches_fetched{ 0 };
+				std::atomic<size_t> batches_released{ 0 };
+			};
+			struct global_state
+			{
+				central_list central[CLASS_COUNT];
+				page_heap pages;
+				heap_counters counters;
+			};
+
+			static global_state& Global() noexcept
+			{
+				// Never destroyed: memory may be freed by static destructors.
+				static global_state* state = new global_state();
+				return *state;
+			}
+			static size_t SpanPages(size_t cls) noexcept
+			{
+				size_t bytes = std::max(class_size(cls) * 8, PAGE_SIZE);
+				return (bytes + PAGE_SIZE - 1) / PAGE_SIZE;
+			}
+			static void Fetch(free_list& list, size_t cls)
+			{
+				global_state& state = Global();
+				central_list& central = state.central[cls];
+				{
+					std::lock_guard lock(central.mutex);
+					if (free_node* batch = central.batches)
+					{
+						central.batches = batch->next_batch;
+						list.head = batch;
+						list.length = 0;
+						for (free_node* node = batch; node; node = node->next)
+							++list.length;
+						state.counters.batches_fetched.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+				}
+
+				// Carve a fresh span: the first batch goes to this thread and
+				// the rest to the central list.
+				size_t size = class_size(cls);
+				size_t pages = SpanPages(cls);
+				std::byte* span = AllocatePages(pages);
+				size_t objects = pages * PAGE_SIZE / size;
+				size_t batch = batch_size(cls);
+				state.counters.spans_carved.fetch_add(1, std::memory_order_relaxed);
+
+				free_node* batches = nullptr;
+				for (size_t first = 0; first < objects; first += batch)
+				{
+					size_t last = std::min(first + batch, objects);
+					for (size_t i = first; i < last; ++i)
+					{
+						auto node = reinterpret_cast<free_node*>(span + i * size);
+						node->next = (i + 1 < last) ? reinterpret_cast<free_node*>(span + (i + 1) * size) : nullptr;
+					}
+					auto head = reinterpret_cast<free_node*>(span + first * size);
+					if (first == 0)
+					{
+						list.head = head;
+						list.length = last;
+					}
+					else
+					{
+						head->next_batch = batches;
+						batches = head;
+					}
+				}
+				if (batches)
+				{
+					free_node* tail = batches;
+					while (tail->next_batch)
+						tail = tail->next_batch;
+
+					std::lock_guard lock(central.mutex);
+					tail->next_batch = central.batches;
+					central.batches = batches;
+				}
+			}
+			// Hands up to one batch from the front of the list to the central list.
+			static void Release(free_list& list, size_t cls) noexcept
+			{
+				free_node* batch = list.head;
+				free_node* last = batch;
+				size_t taken = 1;
+				for (size_t limit = batch_size(cls); taken < limit && last->next; ++taken)
+					last = last->next;
+
+				list.head = last->next;
+				list.length -= taken;
+				last->next = nullptr;
+
+				global_state& state = Global();
+				central_list& central = state.central[cls];
+				std::lock_guard lock(central.mutex);
+				batch->next_batch = central.batches;
+				central.batches = batch;
+				state.counters.batches_released.fetch_add(1, std::memory_order_relaxed);
+			}
+			static std::byte* AllocatePages(size_t pages)
+			{
+				global_state& state = Global();
+				page_heap& heap = state.pages;
+				std::lock_guard lock(heap.mutex);
+				if (free_node* run = heap.runs[pages])
+				{
+					heap.runs[pages] = run->next;
+					return reinterpret_cast<std::byte*>(run);
+				}
+				if (heap.arena_pages < pages)
+				{
+					// The tail of the old arena stays usable as a shorter run.
+					if (heap.arena_pages > 0)
+					{
+						auto tail = reinterpret_cast<free_node*>(heap.arena);
+						tail->next = heap.runs[heap.arena_pages];
+						heap.runs[heap.arena_pages] = tail;
+					}
+					heap.arena = static_cast<std::byte*>(::operator new(ARENA_PAGES * PAGE_SIZE, std::align_val_t(PAGE_SIZE)));
+					heap.arena_pages = ARENA_PAGES;
+					state.counters.arenas_reserved.fetch_add(1, std::memory_order_relaxed);
+					state.counters.bytes_reserved.fetch_add(ARENA_PAGES * PAGE_SIZE, std::memory_order_relaxed);
+				}
+				std::byte* run = heap.arena;
+				heap.arena += pages * PAGE_SIZE;
+				heap.arena_pages -= pages;
+				return run;
+			}
+			static void* AllocateLarge(size_t bytes)
+			{
+				size_t pages = (bytes + PAGE_SIZE - 1) / PAGE_SIZE;
+				if (pages > MAX_SPAN_PAGES)
+					return ::operator new(bytes);
+
+				return AllocatePages(pages);
+			}
+			static void DeallocateLarge(void* ptr, size_t bytes) noexcept
+			{
+				size_t pages = (bytes + PAGE_SIZE - 1) / PAGE_SIZE;
+				if (pages > MAX_SPAN_PAGES)
+				{
+					::operator delete(ptr, bytes);
+					return;
+				}
+
+				page_heap& heap = Global().pages;
+				std::lock_guard lock(heap.mutex);
+				auto run = static_cast<free_node*>(ptr);
+				run->next = heap.runs[pages];
+				heap.runs[pages] = run;
+			}
+			static void Flush(thread_cache& cache) noexcept
+			{
+				for (size_t cls = 0; cls < CLASS_COUNT; ++cls)
+				{
+					while (cache.lists[cls].head)
+						Release(cache.lists[cls], cls);
+				}
+			}
+
+			using local_cache = thread_local_cache<thread_cache, &Flush>;
+		};
+	}
+
+	// Stateless allocator over the process-wide thread-caching heap; all
+	// instances compare equal, so containers can move buffers freely.
+	template <typename T>
+	class thread_cache_allocator
+	{
+	public:
+		using value_type = T;
+
+		thread_cache_allocator() noexcept = default;
+		template <typename U>
+		thread_cache_allocator(const thread_cache_allocator<U>&) noexcept
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(T))
+				throw std::bad_array_new_length();
+
+			return static_cast<T*>(detail::thread_cache_heap::allocate(count * sizeof(T), alignof(T)));
+		}
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			detail::thread_cache_heap::deallocate(ptr, count * sizeof(T), alignof(T));
+		}
+	};
+
+	template <typename T, typename U>
+	bool operator==(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&) noexcept
+	{
+		return true;
+	}
+
+	inline thread_cache_stats thread_cache_allocator_stats() noexcept
+	{
+		return detail::thread_cache_heap::stats();
+	}
+}
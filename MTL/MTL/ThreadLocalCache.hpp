@@ -0,0 +1,53 @@
+#pragma once
+
+namespace mtl
+{
+	namespace detail
+	{
+		// Per-thread cache of an allocator's free lists. The first get() on a
+		// thread registers a thread_local guard whose destructor hands the
+		// cache back through Flush. Other thread_local destructors may still
+		// free memory after that, so flushed() tells the allocator to pass
+		// such frees straight on instead of caching them again.
+		template <typename Cache, void (*Flush)(Cache&) noexcept>
+		class thread_local_cache
+		{
+			struct state
+			{
+				Cache cache{};
+				bool registered{ false };
+				bool flushed{ false };
+			};
+
+			struct guard
+			{
+				~guard()
+				{
+					state& local = t_State;
+					Flush(local.cache);
+					local.flushed = true;
+				}
+			};
+
+		public:
+			static Cache& get() noexcept
+			{
+				state& local = t_State;
+				if (!local.registered)
+				{
+					local.registered = true;
+					static_cast<void>(&t_Guard);
+				}
+				return local.cache;
+			}
+			static bool flushed() noexcept
+			{
+				return t_State.flushed;
+			}
+
+		private:
+			inline static thread_local state t_State;
+			inline static thread_local guard t_Guard;
+		};
+	}
+}
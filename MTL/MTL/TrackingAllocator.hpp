@@ -0,0 +1,324 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "Memory.hpp"
+#include "Vector.hpp"
+
+namespace mtl
+{
+	struct allocation_stats
+	{
+		// Bucket i counts requests of (2^(i-1), 2^i] bytes; the last bucket
+		// takes everything larger.
+		static constexpr size_t HISTOGRAM_BUCKETS{ 32 };
+
+		size_t allocations;
+		size_t deallocations;
+		size_t bytes_allocated;
+		size_t bytes_deallocated;
+		size_t live_bytes;
+		size_t peak_bytes;
+		size_t histogram[HISTOGRAM_BUCKETS];
+
+		static constexpr size_t bucket(size_t bytes) noexcept
+		{
+			return std::min<size_t>(std::bit_width(bytes > 0 ? bytes - 1 : 0), HISTOGRAM_BUCKETS - 1);
+		}
+	};
+
+	namespace detail
+	{
+		class allocation_counters
+		{
+		public:
+			void record_allocation(size_t bytes) noexcept
+			{
+				m_Allocations.fetch_add(1, std::memory_order_relaxed);
+				m_BytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+				m_Histogram[allocation_stats::bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+
+				size_t live = m_LiveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+				size_t peak = m_PeakBytes.load(std::memory_order_relaxed);
+				while (peak < live && !m_PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+				{
+				}
+			}
+			void record_deallocation(size_t bytes) noexcept
+			{
+				m_Deallocations.fetch_add(1, std::memory_order_relaxed);
+				m_BytesDeallocated.fetch_add(bytes, std::memory_order_relaxed);
+				m_LiveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+			}
+
+			allocation_stats snapshot() const noexcept
+			{
+				allocation_stats stats{};
+				stats.allocations = m_Allocations.load(std::memory_order_relaxed);
+				stats.deallocations = m_Deallocations.load(std::memory_order_relaxed);
+				stats.bytes_allocated = m_BytesAllocated.load(std::memory_order_relaxed);
+				stats.bytes_deallocated = m_BytesDeallocated.load(std::memory_order_relaxed);
+				stats.live_bytes = m_LiveBytes.load(std::memory_order_relaxed);
+				stats.peak_bytes = m_PeakBytes.load(std::memory_order_relaxed);
+				for (size_t i = 0; i < allocation_stats::HISTOGRAM_BUCKETS; ++i)
+					stats.histogram[i] = m_Histogram[i].load(std::memory_order_relaxed);
+				return stats;
+			}
+
+			// Live bytes survive a reset so that later deallocations of
+			// existing blocks balance out.
+			void reset() noexcept
+			{
+				m_Allocations.store(0, std::memory_order_relaxed);
+				m_Deallocations.store(0, std::memory_order_relaxed);
+				m_BytesAllocated.store(0, std::memory_order_relaxed);
+				m_BytesDeallocated.store(0, std::memory_order_relaxed);
+				for (std::atomic<size_t>& count : m_Histogram)
+					count.store(0, std::memory_order_relaxed);
+				reset_peak();
+			}
+			void reset_peak() noexcept
+			{
+				m_PeakBytes.store(m_LiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+
+		private:
+			std::atomic<size_t> m_Allocations{};
+			std::atomic<size_t> m_Deallocations{};
+			std::atomic<size_t> m_BytesAllocated{};
+			std::atomic<size_t> m_BytesDeallocated{};
+			std::atomic<size_t> m_LiveBytes{};
+			std::atomic<size_t> m_PeakBytes{};
+			std::atomic<size_t> m_Histogram[allocation_stats::HISTOGRAM_BUCKETS]{};
+		};
+	}
+
+	// Process-wide statistics for every tracking_allocator, one set of
+	// counters per tag name. Counters are created on first use and live for
+	// the rest of the process, so allocators can cache a reference to them.
+	class allocation_registry
+	{
+	public:
+		detail::allocation_counters& counters(std::string_view tag)
+		{
+			std::lock_guard lock{ m_Mutex };
+			if (entry* found = Find(tag))
+				return found->counters;
+
+			m_Entries.push_back(new entry{ std::string(tag), {} });
+			return m_Entries[m_Entries.size() - 1]->counters;
+		}
+
+		// Zeroed stats for tags that have not allocated yet.
+		allocation_stats snapshot(std::string_view tag) const
+		{
+			std::lock_guard lock{ m_Mutex };
+			entry* found = Find(tag);
+			return found ? found->counters.snapshot() : allocation_stats{};
+		}
+		// Sums every tag. Tags peak at different times, so peak_bytes is the
+		// sum of their peaks: an upper bound on the combined peak, not the
+		// combined peak itself.
+		allocation_stats total() const
+		{
+			allocation_stats sum{};
+			for_each([&sum](std::string_view, const allocation_stats& stats)
+			{
+				sum.allocations += stats.allocations;
+				sum.deallocations += stats.deallocations;
+				sum.bytes_allocated += stats.bytes_allocated;
+				sum.bytes_deallocated += stats.bytes_deallocated;
+				sum.live_bytes += stats.live_bytes;
+				sum.peak_bytes += stats.peak_bytes;
+				for (size_t i = 0; i < allocation_stats::HISTOGRAM_BUCKETS; ++i)
+					sum.histogram[i] += stats.histogram[i];
+			});
+			return sum;
+		}
+
+		// Calls f(tag, stats) for every tag, in order of first use.
+		template <typename F>
+		void for_each(F&& f) const
+		{
+			std::lock_guard lock{ m_Mutex };
+			for (const entry* current : m_Entries)
+				f(std::string_view(current->tag), current->counters.snapshot());
+		}
+
+		void reset()
+		{
+			std::lock_guard lock{ m_Mutex };
+			for (entry* current : m_Entries)
+				current->counters.reset();
+		}
+		void reset(std::string_view tag)
+		{
+			std::lock_guard lock{ m_Mutex };
+			if (entry* found = Find(tag))
+				found->counters.reset();
+		}
+
+	private:
+		struct entry
+		{
+			std::string tag;
+			detail::allocation_counters counters;
+		};
+
+		entry* Find(std::string_view tag) const
+		{
+			auto it = std::find_if(m_Entries.begin(), m_Entries.end(), [tag](const entry* current)
+			{
+				return current->tag == tag;
+			});
+			return it != m_Entries.end() ? *it : nullptr;
+		}
+
+		mutable std::mutex m_Mutex;
+		mtl::vector<entry*> m_Entries;
+	};
+
+	// Never destroyed: containers with static storage duration may still
+	// release memory during static destructors.
+	inline allocation_registry& global_allocation_registry()
+	{
+		static allocation_registry* registry = new allocation_registry();
+		return *registry;
+	}
+
+	// Tags name the counters a tracking_allocator reports to; give each
+	// container type its own tag to tell their allocations apart.
+	struct untagged_allocation
+	{
+		static constexpr const char* name = "untagged";
+	};
+
+	template <typename T, typename Tag = untagged_allocation, typename Alloc = std::allocator<T>>
+	class tracking_allocator
+	{
+		using alloc_traits = std::allocator_traits<Alloc>;
+
+		template <typename, typename, typename>
+		friend class tracking_allocator;
+
+	public:
+		using value_type = T;
+		using tag_type = Tag;
+		using upstream_type = Alloc;
+		using propagate_on_container_copy_assignment = typename alloc_traits::propagate_on_container_copy_assignment;
+		using propagate_on_container_move_assignment = typename alloc_traits::propagate_on_container_move_assignment;
+		using propagate_on_container_swap = typename alloc_traits::propagate_on_container_swap;
+		using is_always_equal = typename alloc_traits::is_always_equal;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = tracking_allocator<U, Tag, typename alloc_traits::template rebind_alloc<U>>;
+		};
+
+		tracking_allocator() = default;
+		tracking_allocator(const Alloc& upstream) noexcept
+			: m_Upstream(upstream)
+		{
+		}
+		template <typename U, typename UpstreamU>
+		tracking_allocator(const tracking_allocator<U, Tag, UpstreamU>& other) noexcept
+			: m_Upstream(other.m_Upstream)
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			T* ptr = alloc_traits::allocate(m_Upstream, count);
+			counters().record_allocation(count * sizeof(T));
+			return ptr;
+		}
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			if (!ptr)
+				return;
+
+			counters().record_deallocation(count * sizeof(T));
+			alloc_traits::deallocate(m_Upstream, ptr, count);
+		}
+
+		tracking_allocator select_on_container_copy_construction() const
+		{
+			return tracking_allocator(alloc_traits::select_on_container_copy_construction(m_Upstream));
+		}
+		const Alloc& upstream() const noexcept
+		{
+			return m_Upstream;
+		}
+
+		static allocation_stats stats()
+		{
+			return counters().snapshot();
+		}
+
+		template <typename U, typename UpstreamU>
+		friend bool operator==(const tracking_allocator& lhs, const tracking_allocator<U, Tag, UpstreamU>& rhs) noexcept
+		{
+			return lhs.m_Upstream == rhs.upstream();
+		}
+
+	private:
+		static detail::allocation_counters& counters()
+		{
+			static detail::allocation_counters& cached = global_allocation_registry().counters(Tag::name);
+			return cached;
+		}
+
+		MTL_NO_UNIQUE_ADDRESS Alloc m_Upstream;
+	};
+
+	// Measures what one tag allocates over a scope, for asserting allocation
+	// budgets in tests and reporting them in benchmarks. Peak bytes are the
+	// high-water mark above the live bytes at construction; the scope resets
+	// the tag's peak, so do not nest scopes on one tag. Resetting the tag in
+	// the registry while a scope is live zeroes the counts under it; the
+	// scope then reports 0 for anything below its start instead of wrapping,
+	// so its stats are only meaningful for scopes that see no reset.
+	class allocation_scope
+	{
+	public:
+		explicit allocation_scope(std::string_view tag)
+			: m_Counters(global_allocation_registry().counters(tag))
+		{
+			m_Counters.reset_peak();
+			m_Start = m_Counters.snapshot();
+		}
+		allocation_scope(const allocation_scope&) = delete;
+		allocation_scope& operator=(const allocation_scope&) = delete;
+
+		allocation_stats stats() const noexcept
+		{
+			allocation_stats now = m_Counters.snapshot();
+			allocation_stats delta{};
+			delta.allocations = Since(now.allocations, m_Start.allocations);
+			delta.deallocations = Since(now.deallocations, m_Start.deallocations);
+			delta.bytes_allocated = Since(now.bytes_allocated, m_Start.bytes_allocated);
+			delta.bytes_deallocated = Since(now.bytes_deallocated, m_Start.bytes_deallocated);
+			delta.live_bytes = Since(now.live_bytes, m_Start.live_bytes);
+			delta.peak_bytes = Since(now.peak_bytes, m_Start.live_bytes);
+			for (size_t i = 0; i < allocation_stats::HISTOGRAM_BUCKETS; ++i)
+				delta.histogram[i] = Since(now.histogram[i], m_Start.histogram[i]);
+			return delta;
+		}
+
+	private:
+		static size_t Since(size_t now, size_t start) noexcept
+		{
+			return now > start ? now - start : 0;
+		}
+
+	private:
+		detail::allocation_counters& m_Counters;
+		allocation_stats m_Start;
+	};
+}
@@ -1,15 +1,23 @@
 #pragma once
 #include <algorithm>
 #include <memory>
+#include <utility>
 
 namespace mtl
 {
+	template <typename T>
+	class polymorphic_allocator;
+
 	template<typename T, typename Alloc = std::allocator<T>>
 	class vector
 	{
 	public:
 		class iterator;
+		using allocator_type = Alloc;
 		using alloc_traits = std::allocator_traits<Alloc>;
+		// Fancy when the allocator says so (offset_ptr for shared memory);
+		// iterators and data() still hand out raw pointers.
+		using pointer = typename alloc_traits::pointer;
 
 		vector() = default;
 		~vector()
@@ -17,64 +25,108 @@ namespace mtl
 			clear();
 			alloc_traits::deallocate(m_Allocator, m_Container, m_Capacity);
 		}
+		explicit vector(const Alloc& alloc)
+			: m_Allocator(alloc)
+		{
+		}
 		vector(const vector& rhs)
-			: m_Size(rhs.m_Size), m_Capacity(rhs.m_Capacity)
+			: vector(rhs, alloc_traits::select_on_container_copy_construction(rhs.m_Allocator))
+		{
+		}
+		vector(const vector& rhs, const Alloc& alloc)
+			: m_Capacity(rhs.m_Size), m_Allocator(alloc)
 		{
 			if (m_Capacity > 0)
 			{
 				m_Container = alloc_traits::allocate(m_Allocator, m_Capacity);
 
-				size_t i = 0;
 				for (T& val : rhs)
-					new (&m_Container[i++]) T(val);
+					emplace_back(val);
 			}
 		}
 		vector(vector&& rhs) noexcept
+			: m_Container(std::exchange(rhs.m_Container, nullptr)), m_Size(std::exchange(rhs.m_Size, 0))
+			, m_Capacity(std::exchange(rhs.m_Capacity, 0)), m_Allocator(std::move(rhs.m_Allocator))
+		{
+		}
+		vector(vector&& rhs, const Alloc& alloc)
+			: m_Allocator(alloc)
 		{
-			swap(*this, rhs);
+			if (m_Allocator == rhs.m_Allocator)
+			{
+				swap_contents(rhs);
+			}
+			else
+			{
+				reserve(rhs.m_Size);
+				for (T& val : rhs)
+					emplace_back(std::move(val));
+			}
 		}
-		explicit vector(size_t size)
-			: m_Size(size), m_Capacity(size)
+		explicit vector(size_t size, const Alloc& alloc = Alloc())
+			: m_Capacity(size), m_Allocator(alloc)
 		{
 			if (m_Capacity > 0)
 			{
 				m_Container = alloc_traits::allocate(m_Allocator, m_Capacity);
 
-				for (T& it : *this)
-				{
-					new (&it) T();
-				}
+				for (size_t i = 0; i < size; ++i)
+					emplace_back();
 			}
 		}
-		vector(std::initializer_list<T> list)
-			: m_Size(list.size()), m_Capacity(m_Size)
+		vector(std::initializer_list<T> list, const Alloc& alloc = Alloc())
+			: m_Capacity(list.size()), m_Allocator(alloc)
 		{
 			if (m_Capacity > 0)
 			{
 				m_Container = alloc_traits::allocate(m_Allocator, m_Capacity);
 
-				size_t i = 0;
 				for (auto& val : list)
-					new (&m_Container[i++]) T(val);
+					emplace_back(val);
 			}
 		}
-		vector& operator=(vector rhs)
+		// Assignment keeps this vector's allocator unless the allocator asks
+		// to propagate, so a container never ends up freeing into a resource
+		// it did not allocate from.
+		vector& operator=(const vector& rhs)
 		{
-			swap(*this, rhs);
+			if (this != &rhs)
+			{
+				vector tmp(rhs, alloc_traits::propagate_on_container_copy_assignment::value ? rhs.m_Allocator : m_Allocator);
+				swap(*this, tmp);
+			}
 			return *this;
 		}
+		vector& operator=(vector&& rhs) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+		{
+			if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+			{
+				vector tmp(std::move(rhs));
+				swap(*this, tmp);
+			}
+			else
+			{
+				vector tmp(std::move(rhs), m_Allocator);
+				swap(*this, tmp);
+			}
+			return *this;
+		}
+		allocator_type get_allocator() const noexcept
+		{
+			return m_Allocator;
+		}
 		void push_back(const T& value)
 		{
 			if (m_Capacity <= m_Size)
 				reallocate(recalc_capacity());
-			new (&m_Container[m_Size]) T(value);
+			alloc_traits::construct(m_Allocator, &m_Container[m_Size], value);
 			m_Size++;
 		}
 		void push_back(T&& value)
 		{
 			if (m_Capacity <= m_Size)
 				reallocate(recalc_capacity());
-			new (&m_Container[m_Size]) T(std::move(value));
+			alloc_traits::construct(m_Allocator, &m_Container[m_Size], std::move(value));
 			m_Size++;
 		}
 		template<typename... Args>
@@ -82,14 +134,14 @@ namespace mtl
 		{
 			if (m_Capacity <= m_Size)
 				reallocate(recalc_capacity());
-			new (&m_Container[m_Size]) T(std::forward<Args>(args)...);
+			alloc_traits::construct(m_Allocator, &m_Container[m_Size], std::forward<Args>(args)...);
 			m_Size++;
 		}
 		void pop_back()
 		{
 			if (m_Size > 0)
 			{
-				m_Container[m_Size - 1].~T();
+				alloc_traits::destroy(m_Allocator, &m_Container[m_Size - 1]);
 				m_Size--;
 			}
 		}
@@ -97,7 +149,7 @@ namespace mtl
 		{
 			for (size_t i = 0; i < m_Size; ++i)
 			{
-				m_Container[i].~T();
+				alloc_traits::destroy(m_Allocator, &m_Container[i]);
 			}
 			m_Size = 0;
 		}
@@ -116,11 +168,11 @@ namespace mtl
 		}
 		iterator begin() const noexcept
 		{
-			return m_Container;
+			return data();
 		}
 		iterator end() const noexcept
 		{
-			return m_Container + m_Size;
+			return data() + m_Size;
 		}
 		size_t size() const noexcept
 		{
@@ -136,7 +188,7 @@ namespace mtl
 		}
 		T* data() const noexcept
 		{
-			return m_Container;
+			return std::to_address(m_Container);
 		}
 
 	public:
@@ -188,11 +240,11 @@ namespace mtl
 	private:
 		void reallocate(size_t newCapacity)
 		{
-			T* newBuffer = alloc_traits::allocate(m_Allocator, newCapacity);
+			pointer newBuffer = alloc_traits::allocate(m_Allocator, newCapacity);
 			for (size_t i = 0; i < m_Size; ++i)
 			{
-				new (&newBuffer[i]) T(std::move(m_Container[i]));
-				m_Container[i].~T();
+				alloc_traits::construct(m_Allocator, &newBuffer[i], std::move(m_Container[i]));
+				alloc_traits::destroy(m_Allocator, &m_Container[i]);
 			}
 			alloc_traits::deallocate(m_Allocator, m_Container, m_Capacity);
 			m_Container = newBuffer;
@@ -202,17 +254,28 @@ namespace mtl
 		{
 			return std::max((m_Capacity + m_Capacity / 2), m_Capacity + 1);
 		}
+		void swap_contents(vector& rhs) noexcept
+		{
+			std::swap(m_Container, rhs.m_Container);
+			std::swap(m_Size, rhs.m_Size);
+			std::swap(m_Capacity, rhs.m_Capacity);
+		}
 		friend void swap(vector& lhs, vector& rhs) noexcept
 		{
-			std::swap(lhs.m_Container, rhs.m_Container);
-			std::swap(lhs.m_Size, rhs.m_Size);
-			std::swap(lhs.m_Capacity, rhs.m_Capacity);
+			lhs.swap_contents(rhs);
+			std::swap(lhs.m_Allocator, rhs.m_Allocator);
 		}
 
 	private:
-		T* m_Container{ nullptr };
+		pointer m_Container{ nullptr };
 		size_t m_Size{ 0 };
 		size_t m_Capacity{ 0 };
 		Alloc m_Allocator;
 	};
+
+	namespace pmr
+	{
+		template <typename T>
+		using vector = mtl::vector<T, polymorphic_allocator<T>>;
+	}
 }
@@ -69,4 +69,36 @@ project "GoogleTests"
 	filter "configurations:Release"
 		runtime "Release"
 		optimize "on"
-		
\ No newline at end of file
+
+project "Benchmarks"
+	location "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+
+	targetdir ("bin/%{cfg.buildcfg}/%{prj.name}")
+	objdir ("bin-intermediates/%{cfg.buildcfg}/%{prj.name}")
+
+	files
+	{
+		"%{prj.name}/src/**.cpp",
+		"%{prj.name}/include/**.hpp",
+		"%{prj.name}/benchmarks/**.cpp"
+	}
+
+	includedirs
+	{
+		"MTL",
+		"%{prj.name}/include"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		runtime "Release"
+		optimize "on"